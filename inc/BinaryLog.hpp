@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Strings.hpp"
+#include "Fifo.hpp"
+#include "Streams/Format.hpp"
+#include "Streams/Nested.hpp"
+#include "gcc_type_traits.h"
+#include <stdint.h>
+
+/**
+ * Compact binary encoding of log messages, as an alternative to formatting them into text on the device.
+ *
+ * A record is RECORD_START, the PROGMEM address of the logger name, the encoded arguments, and END. F() strings
+ * are sent as their length and PROGMEM address only, and integers as their raw little-endian bytes, so a record
+ * typically is a handful of bytes. The F() addresses double as message IDs: since every call site has its own
+ * strings in flash, the firmware image itself is the catalog that BinaryLogDecoder uses to render the text again.
+ */
+namespace Logging {
+namespace BinaryLog {
+
+enum Tag: uint8_t {
+    END = 0x00,
+    /** followed by the string's length and its PROGMEM address */
+    PSTR = 0x01,
+    /** followed by one raw character */
+    CHAR = 0x02,
+    /** followed by a length and that many characters, for arguments that were formatted on the device */
+    TEXT = 0x03,
+    /** followed by one byte, to be rendered as 2 hexadecimal digits */
+    HEX8 = 0x04,
+    /** ORed with the size (1, 2 or 4), followed by that many bytes of an unsigned decimal */
+    UNSIGNED = 0x10,
+    /** ORed with the size (1, 2 or 4), followed by that many bytes of a signed decimal */
+    SIGNED = 0x20,
+
+    RECORD_START = 0xA5
+};
+
+/** Maximum length of an argument that has no binary encoding, and is formatted into text on the device instead. */
+constexpr uint8_t maxTextLength = 32;
+
+template <uint8_t length>
+auto encode(StringInProgmem<length> *s) {
+    return ::Streams::Nested([s] (auto write) {
+        return write(uint8_t(PSTR), length, uintptr_t(s));
+    });
+}
+
+template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+auto encode(::Streams::Impl::Decimal<T> v) {
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4, "Only 8, 16 and 32 bit decimals are supported");
+    return ::Streams::Nested([v] (auto write) {
+        return write(uint8_t(((T(-1) < T(0)) ? SIGNED : UNSIGNED) | sizeof(T)), v.value);
+    });
+}
+
+inline auto encode(::Streams::Impl::Hexadecimal<uint8_t> v) {
+    return ::Streams::Nested([v] (auto write) {
+        return write(uint8_t(HEX8), v.value);
+    });
+}
+
+inline auto encode(uint8_t ch) {
+    return ::Streams::Nested([ch] (auto write) {
+        return write(uint8_t(CHAR), ch);
+    });
+}
+
+inline auto encode(char ch) {
+    return encode(uint8_t(ch));
+}
+
+/** Any other argument is formatted into text on the device, as it would have been for text logging. */
+template <typename T>
+auto encode(T v) {
+    return ::Streams::Nested([v] (auto write) {
+        Fifo<maxTextLength> text;
+        text.write(v);
+        if (!write(uint8_t(TEXT), uint8_t(text.getSize()))) {
+            return false;
+        }
+        while (text.hasContent()) {
+            uint8_t ch;
+            text.uncheckedRead(ch);
+            if (!write(ch)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+/** Returns a writable record for a log message with [args] on the logger named [loggerName]. */
+template <typename loggerName, typename... types>
+auto record(types... args) {
+    return ::Streams::Nested([args...] (auto write) {
+        return write(uint8_t(RECORD_START), uintptr_t(loggerName::data()), encode(args)..., uint8_t(END));
+    });
+}
+
+}
+}
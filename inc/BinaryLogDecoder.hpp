@@ -0,0 +1,187 @@
+#pragma once
+
+#ifdef AVR
+#error BinaryLogDecoder is meant for the host that receives the log, not for the device
+#endif
+
+#include "BinaryLog.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Logging {
+
+/**
+ * Renders records written in the BinaryLog format back into text lines, in the same form as text logging would have
+ * sent them, i.e. "<logger>: <message>". Bytes may be fed in any chunks as they arrive. Anything that isn't a valid
+ * record is skipped until the next RECORD_START.
+ */
+class BinaryLogDecoder {
+public:
+    /** Looks up the string of [length] characters at PROGMEM address [address]. */
+    typedef std::function<std::string(uint64_t address, uint8_t length)> catalog_t;
+
+private:
+    const uint8_t pointerSize;
+    const catalog_t catalog;
+    std::vector<uint8_t> pending;
+
+    enum class Result { VALID, INCOMPLETE, INVALID };
+
+    struct Cursor {
+        const std::vector<uint8_t> &data;
+        size_t pos;
+
+        bool has(size_t count) const {
+            return pos + count <= data.size();
+        }
+
+        uint64_t take(uint8_t count) {
+            uint64_t value = 0;
+            for (uint8_t i = 0; i < count; i++) {
+                value |= uint64_t(data[pos++]) << (8 * i);
+            }
+            return value;
+        }
+    };
+
+    static char hexChar(uint8_t value) {
+        return (value < 10) ? '0' + value : 'A' + (value - 10);
+    }
+
+    static int64_t signExtend(uint64_t value, uint8_t size) {
+        const uint8_t shift = 64 - 8 * size;
+        return int64_t(value << shift) >> shift;
+    }
+
+    Result decodeArgument(Cursor &c, std::string *line) const {
+        if (!c.has(1)) {
+            return Result::INCOMPLETE;
+        }
+        const uint8_t tag = c.take(1);
+        if (tag == BinaryLog::PSTR) {
+            if (!c.has(1 + pointerSize)) return Result::INCOMPLETE;
+            const uint8_t length = c.take(1);
+            const uint64_t address = c.take(pointerSize);
+            if (line) *line += catalog(address, length);
+        } else if (tag == BinaryLog::CHAR) {
+            if (!c.has(1)) return Result::INCOMPLETE;
+            const char ch = c.take(1);
+            if (line) *line += ch;
+        } else if (tag == BinaryLog::TEXT) {
+            if (!c.has(1)) return Result::INCOMPLETE;
+            const uint8_t length = c.take(1);
+            if (!c.has(length)) return Result::INCOMPLETE;
+            for (uint8_t i = 0; i < length; i++) {
+                const char ch = c.take(1);
+                if (line) *line += ch;
+            }
+        } else if (tag == BinaryLog::HEX8) {
+            if (!c.has(1)) return Result::INCOMPLETE;
+            const uint8_t value = c.take(1);
+            if (line) {
+                *line += hexChar(value >> 4);
+                *line += hexChar(value & 0x0F);
+            }
+        } else if ((tag & 0xF0) == BinaryLog::UNSIGNED || (tag & 0xF0) == BinaryLog::SIGNED) {
+            const uint8_t size = tag & 0x0F;
+            if (size != 1 && size != 2 && size != 4) return Result::INVALID;
+            if (!c.has(size)) return Result::INCOMPLETE;
+            const uint64_t value = c.take(size);
+            if (line) {
+                *line += ((tag & 0xF0) == BinaryLog::SIGNED) ? std::to_string(signExtend(value, size)) : std::to_string(value);
+            }
+        } else {
+            return Result::INVALID;
+        }
+        return Result::VALID;
+    }
+
+    /** Parses one record at [c], only rendering it into [line] if given, i.e. after it turned out to be valid. */
+    Result decodeRecord(Cursor &c, std::string *line) const {
+        c.pos++; // RECORD_START
+        if (!c.has(pointerSize)) {
+            return Result::INCOMPLETE;
+        }
+        const uint64_t logger = c.take(pointerSize);
+        if (line) {
+            *line = catalog(logger, 0xFF) + ": ";
+        }
+        while (true) {
+            if (!c.has(1)) {
+                return Result::INCOMPLETE;
+            }
+            if (c.data[c.pos] == BinaryLog::END) {
+                c.pos++;
+                return Result::VALID;
+            }
+            const Result result = decodeArgument(c, line);
+            if (result != Result::VALID) {
+                return result;
+            }
+        }
+    }
+
+public:
+    /**
+     * Creates a decoder for a device with [pointerSize]-byte PROGMEM addresses (2 for AVR), resolving strings through
+     * [catalog]. Logger names are looked up with a length of 255, and should end at their terminating zero.
+     */
+    BinaryLogDecoder(uint8_t pointerSize, catalog_t catalog): pointerSize(pointerSize), catalog(catalog) {}
+
+    /** Adds [length] received bytes, returning the lines of all records that are now complete. */
+    std::vector<std::string> decode(const uint8_t *data, size_t length) {
+        pending.insert(pending.end(), data, data + length);
+        std::vector<std::string> lines;
+        size_t start = 0;
+        while (start < pending.size()) {
+            if (pending[start] != BinaryLog::RECORD_START) {
+                start++;
+                continue;
+            }
+            Cursor c = { pending, start };
+            const Result result = decodeRecord(c, nullptr);
+            if (result == Result::INCOMPLETE) {
+                break;
+            } else if (result == Result::INVALID) {
+                start++;
+            } else {
+                Cursor r = { pending, start };
+                std::string line;
+                decodeRecord(r, &line);
+                lines.push_back(line);
+                start = c.pos;
+            }
+        }
+        pending.erase(pending.begin(), pending.begin() + start);
+        return lines;
+    }
+
+    /**
+     * Returns a catalog that reads strings from a raw firmware image, e.g. as made by avr-objcopy -O binary, in
+     * which every PROGMEM string sits at its own address.
+     */
+    static catalog_t flashImage(std::vector<uint8_t> image) {
+        return [image] (uint64_t address, uint8_t length) {
+            std::string s;
+            for (uint64_t i = address; i < image.size() && i < address + length && image[i] != 0; i++) {
+                s += char(image[i]);
+            }
+            return s;
+        };
+    }
+
+    /** Returns a catalog that reads strings from this process' own memory, for records written on the host. */
+    static catalog_t hostMemory() {
+        return [] (uint64_t address, uint8_t length) {
+            const char *p = (const char *) uintptr_t(address);
+            std::string s;
+            for (uint8_t i = 0; i < length && p[i] != 0; i++) {
+                s += p[i];
+            }
+            return s;
+        };
+    }
+};
+
+}
@@ -28,4 +28,24 @@ public:
     }
 };
 
+/**
+ * Dallas / Maxim 8-bit CRC, as used by OneWire devices for their address and scratchpad.
+ */
+class CRC8 {
+    uint8_t value = 0;
+public:
+    inline void reset() {
+        value = 0;
+    }
+    inline void append(uint8_t b) {
+        value = _crc_ibutton_update(value, b);
+    }
+    constexpr inline uint8_t get() const {
+        return value;
+    }
+    inline bool isValid() {
+        return value == 0;
+    }
+};
+
 #endif
@@ -68,6 +68,18 @@ public:
 
     void uncheckedWrite(uint8_t b);
 
+    /**
+     * Reserves one byte in the chunk currently being written, to be filled in later through [ptr].
+     * Returns false if the fifo is full, or not writing.
+     */
+    bool reserve(volatile uint8_t * &ptr);
+
+    /** Invokes [f] with every byte written to the current chunk after [ptr] was reserved. */
+    template <typename lambda_t>
+    void forEachWrittenAfter(volatile uint8_t *ptr, lambda_t f) const {
+        data->forEachWrittenAfter(ptr, f);
+    }
+
     void writeEnd();
 
     void writeAbort();
@@ -18,34 +18,46 @@ using namespace HAL::Atmel;
 using namespace HAL::Atmel::InterruptHandlers;
 
 enum class DHTState: uint8_t {
-    OFF, BOOTING, IDLE, SIGNALING, SYNC_LOW, SYNC_HIGH, RECEIVING_LOW, RECEIVING_HIGH
+    OFF, BOOTING, IDLE, SIGNALING, RECEIVING
 };
 
 namespace Impl {
 
-/** Abstract base class for all DHT-based temperature & humidity sensors */
+/**
+ * Abstract base class for all DHT-based temperature & humidity sensors.
+ *
+ * While the sensor transmits, the pulse counter's interrupt handler only records edges. The complete 40-bit
+ * frame is then decoded from the recorded pulses in one pass from loop(), and checked against its checksum.
+ */
 template <typename datapin_t, typename powerpin_t, typename comparator_t, typename rt_t>
 class DHT {
 	static_assert(!(Logging::Log<Loggers::Serial>::isTimingEnabled()), "Current PulseCounter implementation is too slow to count 80us pulses AND output profiling data. Disable timing data please.");
 
     typedef DHT<datapin_t,powerpin_t,comparator_t,rt_t> This;
     typedef Logging::Log<Loggers::DHT11> log;
+    typedef typename comparator_t::timervalue_t::value_t count_t;
+
+    /** Room for a start pulse, 2 sync pulses, 80 data pulses and the trailing pulses, as (length, level) pairs. */
+    static constexpr uint8_t pulseBufferSize = ((sizeof(count_t) + 1) * 88 > 255) ? 255 : (sizeof(count_t) + 1) * 88;
 
     datapin_t *pin;
     powerpin_t *power;
     DHTState state;
-    PulseCounter<comparator_t, datapin_t, 200> counter;
+    PulseCounter<comparator_t, datapin_t, pulseBufferSize> counter;
     VariableDeadline<rt_t> timeout;
-    uint8_t bit = 7;
-    uint8_t pos = 0;
     uint8_t data[4] = { 0, 0, 0, 0 };
-    bool seenHigh = false;
     uint8_t lastFailure = -1;
 
 public:
+    static constexpr uint8_t NO_SYNC = 1;
+    static constexpr uint8_t INCOMPLETE = 2;
+    static constexpr uint8_t CHECKSUM = 3;
+    static constexpr uint8_t BUSY = 253;
+
     void powerOff() {
     	AtomicScope _;
         power->setLow();
+        counter.pause();
         state = DHTState::OFF;
     }
 
@@ -72,7 +84,7 @@ public:
             state = DHTState::SIGNALING;
         } else {
             log::debug(F("Still booting, or measurement already in progress."));
-            lastFailure = 253;
+            lastFailure = BUSY;
         }
     }
 
@@ -81,36 +93,12 @@ protected:
         return data[idx];
     }
 private:
-    void reset(uint8_t failure) {
-        log::debug(F("Resetting, err="), dec(failure));
+    void finish(uint8_t failure) {
+        log::debug(F("Done, err="), dec(failure));
+        counter.pause();
         lastFailure = failure;
         pin->configureAsInputWithPullup();
         state = DHTState::IDLE;
-        bit = 7;
-        pos = 0;
-        seenHigh = false;
-        counter.pause();
-    }
-
-    void receive(bool value) {
-    	log::debug('0' + value);
-        if (value) {
-            data[pos] |= (1 << bit);
-        } else {
-            data[pos] &= ~(1 << bit);
-        }
-        if (bit > 0) {
-            bit--;
-        } else {
-            bit = 7;
-            log::debug(F("in "), dec(data[pos]));
-            pos++;
-        }
-        if (pos >= 5) {
-            reset(0);
-        } else {
-            state = DHTState::RECEIVING_LOW;
-        }
     }
 
     void booting() {
@@ -125,66 +113,57 @@ private:
             log::debug(F("Switching to input"));
             pin->configureAsInputWithPullup();
             counter.resume();
-            state = DHTState::SYNC_LOW;
+            // The whole frame takes at most ~5.5ms: 160us sync, and 40 bits of at most 120us each.
+            timeout.schedule(8_ms);
+            state = DHTState::RECEIVING;
         }
     }
 
-    template <typename f_t>
-    void expectPulse(f_t f) {
-        counter.on([this, f] (auto pulse) {
-            log::debug(dec(uint8_t(state)), ':', as<Pulse::TEXT>(&pulse));
-            if (pulse.isEmpty()) {
-                this->reset(uint8_t(state));
-            } else {
-                f(pulse);
+    /**
+     * Decodes all pulses recorded during the frame. Anything before the 80us low + 80us high sync pair is
+     * ignored. After that, every high pulse is one bit, which is a 1 if it's longer than 50us.
+     */
+    void decode() {
+        uint8_t bytes[5] = { 0, 0, 0, 0, 0 };
+        uint8_t bits = 0;
+        bool sawSyncLow = false;
+        bool synced = false;
+
+        counter.onMax(255, [&] (auto pulse) {
+            if (pulse.isEmpty() || bits >= 40) {
+                return;
             }
-        });
-    }
-
-    void sync_low() {
-        expectPulse([this] (auto pulse) {
-            if (pulse.isLow() && pulse > 60_us && pulse < 120_us) {
-                state = DHTState::SYNC_HIGH;
+            if (synced) {
+                if (pulse.isHigh()) {
+                    bytes[bits / 8] = (bytes[bits / 8] << 1) | ((pulse < 50_us) ? 0 : 1);
+                    bits++;
+                }
             } else {
-            	log::debug(F("Ignoring "));
-            }
-        });
-    }
-
-    void sync_high() {
-        expectPulse([this] (auto pulse) {
-            if (pulse.isHigh() && pulse > 60_us && pulse < 120_us) {
-                state = DHTState::RECEIVING_LOW;
+                const bool syncLength = pulse > 60_us && pulse < 120_us;
+                synced = sawSyncLow && syncLength && pulse.isHigh();
+                sawSyncLow = syncLength && pulse.isLow();
             }
         });
-    }
 
-    void receiving_low() {
-        expectPulse([this] (auto pulse) {
-            if (pulse.isLow()) {
-                if (pulse > 30_us && pulse < 80_us) {
-                    state = DHTState::RECEIVING_HIGH;
-                } else {
-                    this->reset(pulse.getDuration());
-                }
-            } else {
-                this->reset(43);
+        if (!synced) {
+            finish(NO_SYNC);
+        } else if (bits < 40) {
+            finish(INCOMPLETE);
+        } else if (uint8_t(bytes[0] + bytes[1] + bytes[2] + bytes[3]) != bytes[4]) {
+            finish(CHECKSUM);
+        } else {
+            for (uint8_t i = 0; i < 4; i++) {
+                data[i] = bytes[i];
             }
-        });
+            finish(0);
+        }
     }
 
-    void receiving_high() {
-        expectPulse([this] (auto pulse) {
-            if (pulse.isHigh()) {
-                if (pulse < 50_us) {
-                    this->receive(0);
-                } else {
-                    this->receive(1);
-                }
-            } else {
-                this->reset(44);
-            }
-        });
+    void receiving() {
+        if (timeout.isNow()) {
+            counter.pause();
+            decode();
+        }
     }
 
 public:
@@ -208,10 +187,7 @@ public:
         case DHTState::IDLE: break;
         case DHTState::BOOTING: booting(); break;
         case DHTState::SIGNALING: signaling(); break;
-        case DHTState::SYNC_LOW: sync_low(); break;
-        case DHTState::SYNC_HIGH: sync_high(); break;
-        case DHTState::RECEIVING_LOW: receiving_low(); break;
-        case DHTState::RECEIVING_HIGH: receiving_high(); break;
+        case DHTState::RECEIVING: receiving(); break;
         }
     }
 
@@ -234,6 +210,8 @@ public:
     auto getTaskState() const {
     	if (isIdle()) {
     		return TaskState::idle();
+    	} else if (state == DHTState::RECEIVING) {
+    		return TaskState::busy(SleepMode::IDLE);  // the comparator must keep running to time the pulses
     	} else {
     		return TaskState::busy(timeLeft(), SleepMode::POWER_DOWN);
     	}
@@ -247,7 +225,11 @@ public:
     	return !isIdle();
     }
 
-    /** Returns any failure code that occurred during the most recent measurement, or 0 for no failure. */
+    /**
+     * Returns any failure code that occurred during the most recent measurement, or 0 for no failure:
+     * NO_SYNC if the sensor didn't answer, INCOMPLETE if fewer than 40 bits arrived, CHECKSUM if the
+     * checksum byte didn't match, or BUSY if measure() was called while a measurement was in progress.
+     */
     uint8_t getLastFailure() const {
         return lastFailure;
     }
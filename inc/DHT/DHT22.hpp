@@ -30,9 +30,9 @@ template <typename datapin_t, typename powerpin_t, typename comparator_t, typena
 class DHT22: public DHT<datapin_t, powerpin_t, comparator_t, rt_t> {
     typedef DHT22<datapin_t, powerpin_t, comparator_t, rt_t> This;
     typedef DHT<datapin_t, powerpin_t, comparator_t, rt_t> Super;
-    using Super::getLastFailure;
 public:
     using Super::DHT;
+    using Super::getLastFailure;
 
     /**
      * Returns the temperature in tenths of degrees celcius, e.g. 320 for 32 degrees C or -15 for -1.5 degrees C.
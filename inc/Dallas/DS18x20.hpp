@@ -5,6 +5,7 @@
 #include "Option.hpp"
 #include <stdint.h>
 #include <Tasks/TaskState.hpp>
+#include "Time/RealTimer.hpp"
 
 namespace Dallas {
 
@@ -13,6 +14,32 @@ namespace Impl {
 using namespace Time;
 using namespace Streams;
 
+/**
+ * Converts a DS18x20 scratchpad into tenths of degrees celcius, for a device with the given family code.
+ */
+inline int16_t scratchpadToTemperature(uint8_t family, const uint8_t *data) {
+    int16_t raw = (data[1] << 8) | data[0];
+    if (family == 0x10) { // DS18S20, or old DS1820
+        raw = raw << 3; // 9 bit resolution default
+        if (data[7] == 0x10) {
+            // "count remain" gives full 12 bit resolution
+            raw = (raw & 0xFFF0) + 12 - data[6];
+        }
+    } else {
+        uint8_t cfg = (data[4] & 0x60);
+        // at lower res, the low bits are undefined, so let's zero them
+        if (cfg == 0x00)
+            raw = raw & ~7; // 9 bit resolution, 93.75 ms
+        else if (cfg == 0x20)
+            raw = raw & ~3; // 10 bit res, 187.5 ms
+        else if (cfg == 0x40)
+            raw = raw & ~1; // 11 bit res, 375 ms
+        //// default is 12 bit resolution, 750 ms conversion time
+    }
+
+    return (int32_t(raw) * 100) / 160;
+}
+
 /**
  * Dallas DS18B20 temperature sensor
  *
@@ -87,26 +114,7 @@ class DS18x20 {
             data[i] = wire->read();
         }
 
-        int16_t raw = (data[1] << 8) | data[0];
-        if (addr.addr[0] == 0x10) { // DS18S20, or old DS1820
-            raw = raw << 3; // 9 bit resolution default
-            if (data[7] == 0x10) {
-                // "count remain" gives full 12 bit resolution
-                raw = (raw & 0xFFF0) + 12 - data[6];
-            }
-        } else {
-            uint8_t cfg = (data[4] & 0x60);
-            // at lower res, the low bits are undefined, so let's zero them
-            if (cfg == 0x00)
-                raw = raw & ~7; // 9 bit resolution, 93.75 ms
-            else if (cfg == 0x20)
-                raw = raw & ~3; // 10 bit res, 187.5 ms
-            else if (cfg == 0x40)
-                raw = raw & ~1; // 11 bit res, 375 ms
-            //// default is 12 bit resolution, 750 ms conversion time
-        }
-
-        temp = (int32_t(raw) * 100) / 160;
+        temp = scratchpadToTemperature(addr.addr[0], data);
     }
 
     void update() {
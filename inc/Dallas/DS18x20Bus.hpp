@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Dallas/DS18x20.hpp"
+#include "Dallas/OneWireMaster.hpp"
+#include "Time/RealTimer.hpp"
+#include "Tasks/TaskState.hpp"
+#include "CRC.hpp"
+#include "Option.hpp"
+
+namespace Dallas {
+
+namespace Impl {
+
+using namespace Time;
+
+/**
+ * All DS18x20 temperature sensors on one OneWire bus. On construction, the bus is searched for up to [maxDevices]
+ * sensors. measure() then starts the conversion on all of them at once with a Skip ROM broadcast, after which
+ * each sensor's scratchpad is read and checked against its CRC. A sweep over all sensors takes one conversion
+ * time, rather than one per sensor.
+ *
+ * Everything runs from loop() on top of an interrupt-driven OneWireMaster, so the main loop is never blocked on
+ * the bus.
+ */
+template <typename onewire_t, typename rt_t, uint8_t maxDevices>
+class DS18x20Bus {
+    typedef Logging::Log<Loggers::Dallas> log;
+
+    static constexpr uint8_t SKIP_ROM = 0xCC;
+    static constexpr uint8_t CONVERT_T = 0x44;
+    static constexpr uint8_t READ_SCRATCHPAD = 0xBE;
+
+    enum class State: uint8_t { DISCOVERING, IDLE, CONVERTING, READING };
+
+    onewire_t * const wire;
+    rt_t * const rt;
+    Deadline<rt_t,decltype(750_ms)> conversionDone = { *rt };
+
+    State state = State::DISCOVERING;
+    OneWireAddress addresses[maxDevices];
+    Option<int16_t> temperatures[maxDevices];
+    uint8_t count = 0;
+    uint8_t reading = 0;
+    uint8_t crcErrors = 0;
+
+    static bool isValid(const uint8_t *data, uint8_t length) {
+        CRC8 crc;
+        for (uint8_t i = 0; i < length; i++) {
+            crc.append(data[i]);
+        }
+        return crc.isValid();
+    }
+
+    void discover() {
+        OneWireAddress addr;
+        if (wire->readSearchResult(addr) && count < maxDevices) {
+            if (isValid(addr.addr, 8)) {
+                addresses[count] = addr;
+                count++;
+            } else {
+                crcErrors++;
+            }
+            wire->search();
+        } else {
+            log::debug(F("found "), dec(count));
+            state = State::IDLE;
+        }
+    }
+
+    void startReading(uint8_t index) {
+        reading = index;
+        wire->reset();
+        wire->select(addresses[index]);
+        wire->write(READ_SCRATCHPAD);
+        wire->read(9);
+        state = State::READING;
+    }
+
+    void readScratchpad() {
+        uint8_t present = 0;
+        uint8_t data[9];
+        wire->in().read(&present, &data[0], &data[1], &data[2], &data[3], &data[4], &data[5], &data[6], &data[7], &data[8]);
+        if (present && isValid(data, 9)) {
+            temperatures[reading] = scratchpadToTemperature(addresses[reading].addr[0], data);
+        } else {
+            if (present) {
+                crcErrors++;
+            }
+            temperatures[reading] = none();
+        }
+        if (reading + 1 < count) {
+            startReading(reading + 1);
+        } else {
+            state = State::IDLE;
+        }
+    }
+
+    void conversionElapsed() {
+        uint8_t present = 0;
+        wire->in().read(&present);
+        if (present) {
+            startReading(0);
+        } else {
+            for (auto &t: temperatures) t = none();
+            state = State::IDLE;
+        }
+    }
+
+public:
+    DS18x20Bus(onewire_t &w, rt_t &r): wire(&w), rt(&r) {
+        conversionDone.cancel();
+        wire->search();
+    }
+
+    /** Starts a measurement on all sensors, unless one is already in progress or the bus still is being searched. */
+    void measure() {
+        if (state != State::IDLE || count == 0) {
+            return;
+        }
+        wire->reset();
+        wire->write(SKIP_ROM, CONVERT_T);
+        conversionDone.schedule();
+        state = State::CONVERTING;
+    }
+
+    void loop() {
+        if (!wire->isIdle()) {
+            return;
+        }
+        switch (state) {
+        case State::DISCOVERING:
+            discover();
+            break;
+        case State::CONVERTING:
+            if (conversionDone.isNow()) {
+                conversionElapsed();
+            }
+            break;
+        case State::READING:
+            readScratchpad();
+            break;
+        case State::IDLE:
+            break;
+        }
+    }
+
+    /** Returns whether the bus has been searched, and no measurement is in progress. */
+    bool isIdle() const {
+        return state == State::IDLE;
+    }
+
+    /** Returns the number of sensors found on the bus. */
+    uint8_t getCount() const {
+        return count;
+    }
+
+    const OneWireAddress &getAddress(uint8_t index) const {
+        return addresses[index];
+    }
+
+    /**
+     * Returns the temperature of the sensor at [index] in tenths of degrees celcius, as of the last measurement,
+     * or none() if it didn't respond correctly.
+     */
+    Option<int16_t> getTemperature(uint8_t index) const {
+        if (index < count) {
+            return temperatures[index];
+        } else {
+            return none();
+        }
+    }
+
+    /** Returns the number of addresses and scratchpads that were dropped because of a CRC mismatch. */
+    uint8_t getCRCErrors() const {
+        return crcErrors;
+    }
+
+    TaskState getTaskState() const {
+        if (state == State::CONVERTING && wire->isIdle()) {
+            return TaskState(conversionDone.timeLeftIfScheduled(), HAL::Atmel::SleepMode::POWER_DOWN);
+        } else if (state == State::IDLE) {
+            return TaskState::idle();
+        } else {
+            return TaskState::busy(HAL::Atmel::SleepMode::IDLE);
+        }
+    }
+};
+
+} // namespace Impl
+
+template <uint8_t maxDevices = 10, typename onewire_t, typename rt_t>
+Impl::DS18x20Bus<onewire_t, rt_t, maxDevices> DS18x20Bus(onewire_t &wire, rt_t &rt) {
+    return { wire, rt };
+}
+
+} // namespace Dallas
@@ -0,0 +1,419 @@
+#pragma once
+
+#include "HAL/Atmel/InterruptHandlers.hpp"
+#include "Time/UnitLiterals.hpp"
+#include "Tasks/TaskState.hpp"
+#include "Dallas/OneWire.hpp"
+#include "Fifo.hpp"
+#include "AtomicScope.hpp"
+
+namespace Dallas {
+
+namespace Impl {
+
+using namespace HAL::Atmel::InterruptHandlers;
+using namespace Time;
+
+/**
+ * Interrupt-driven OneWire master. Operations are queued into a command fifo, and carried out one time slot
+ * at a time from a timer comparator interrupt. Only the first 13us of a slot are busy-waited inside the interrupt;
+ * the remainder of every slot, and the long reset pulse, run on the comparator, so the main loop never waits on
+ * the bus.
+ *
+ * Results are appended to a result fifo in the order their operations were queued:
+ *   - reset() appends 1 if a device responded with a presence pulse, 0 otherwise.
+ *   - read(n) appends n bytes.
+ *   - search() appends 1 and the 8 address bytes of the next device, or 0 and 8 zero bytes after the last device.
+ *
+ * The comparator should not be shared with another user, but can run on the same timer as one.
+ */
+template <typename pin_t, typename comparator_t, uint8_t commandFifoSize, uint8_t resultFifoSize>
+class OneWireMaster {
+    typedef OneWireMaster<pin_t, comparator_t, commandFifoSize, resultFifoSize> This;
+    typedef typename comparator_t::value_t count_t;
+
+    static constexpr uint16_t resetLow = (480_us).template toCountsOn<comparator_t>().getValue();
+    static constexpr uint16_t presenceWait = (70_us).template toCountsOn<comparator_t>().getValue();
+    static constexpr uint16_t resetRecovery = (410_us).template toCountsOn<comparator_t>().getValue();
+    static constexpr uint16_t write0Low = (60_us).template toCountsOn<comparator_t>().getValue();
+    static constexpr uint16_t write0Recovery = (10_us).template toCountsOn<comparator_t>().getValue();
+    static constexpr uint16_t slotLength = (70_us).template toCountsOn<comparator_t>().getValue();
+    static_assert(write0Recovery > 2, "Timer prescaler too high for OneWire timing. Decrease timer prescaler.");
+
+    enum class Op: uint8_t { NONE, RESET, WRITE, READ, SEARCH };
+    enum class Phase: uint8_t { IDLE, NEXT, RESET_RELEASE, RESET_SAMPLE, WRITE0_RELEASE };
+    enum class SearchStep: uint8_t { RESET, COMMAND, ID_BIT, CMP_BIT, DIRECTION, DONE };
+
+    static constexpr uint8_t SEARCH_ROM = 0xF0;
+    static constexpr uint8_t MATCH_ROM = 0x55;
+
+    pin_t * const pin;
+    comparator_t * const comparator;
+    const bool power;
+
+    Fifo<commandFifoSize> commands;
+    Fifo<resultFifoSize> results;
+
+    volatile Phase phase = Phase::IDLE;
+    uint16_t waitLeft = 0;
+    Op op = Op::NONE;
+    uint8_t bytesLeft = 0;
+    uint8_t current = 0;
+    uint8_t bitMask = 0;
+    bool present = false;
+
+    SearchStep searchStep = SearchStep::RESET;
+    uint8_t rom[8];
+    uint8_t bitNumber = 0;
+    uint8_t lastZero = 0;
+    uint8_t lastDiscrepancy = 0;
+    bool lastDevice = false;
+    bool idBit = false;
+    bool cmpBit = false;
+
+    void wait(uint16_t counts) {
+        constexpr uint16_t max = count_t(-1) / 2;
+        if (counts > max) {
+            waitLeft = counts - max;
+            counts = max;
+        } else {
+            waitLeft = 0;
+        }
+        comparator->setTarget(comparator->getTarget() + count_t(counts));
+    }
+
+    void release() {
+        pin->configureAsInputWithPullup();
+    }
+
+    void startReset() {
+        pin->configureAsOutputLow();
+        wait(resetLow);
+        phase = Phase::RESET_RELEASE;
+    }
+
+    void writeSlot(bool bit) {
+        AtomicScope _;
+        pin->configureAsOutputLow();
+        if (bit) {
+            delay(10_us);
+            pin->setHigh();
+            wait(slotLength);
+            phase = Phase::NEXT;
+        } else {
+            wait(write0Low);
+            phase = Phase::WRITE0_RELEASE;
+        }
+    }
+
+    bool readSlot() {
+        AtomicScope _;
+        pin->configureAsOutputLow();
+        delay(3_us);
+        release();
+        delay(10_us);
+        const bool bit = pin->isHigh();
+        wait(slotLength);
+        phase = Phase::NEXT;
+        return bit;
+    }
+
+    void endSearch(bool found) {
+        if (found && rom[0] != 0) {
+            lastDiscrepancy = lastZero;
+            lastDevice = (lastDiscrepancy == 0);
+            results.fastwrite(1);
+            for (uint8_t b: rom) results.fastwrite(b);
+        } else {
+            lastDiscrepancy = 0;
+            lastDevice = false;
+            results.fastwrite(0);
+            for (uint8_t i = 0; i < 8; i++) results.fastwrite(0);
+        }
+        op = Op::NONE;
+    }
+
+    /** Performs one slot of the search. Returns false if the search has ended without using a slot. */
+    bool searchSlot() {
+        switch (searchStep) {
+        case SearchStep::RESET:
+            if (lastDevice) {
+                endSearch(false);
+                return false;
+            }
+            searchStep = SearchStep::COMMAND;
+            current = SEARCH_ROM;
+            bitMask = 1;
+            startReset();
+            return true;
+        case SearchStep::COMMAND:
+            if (!present) {
+                endSearch(false);
+                return false;
+            }
+            writeSlot(current & bitMask);
+            bitMask <<= 1;
+            if (bitMask == 0) {
+                searchStep = SearchStep::ID_BIT;
+                bitNumber = 1;
+                lastZero = 0;
+            }
+            return true;
+        case SearchStep::ID_BIT:
+            idBit = readSlot();
+            searchStep = SearchStep::CMP_BIT;
+            return true;
+        case SearchStep::CMP_BIT:
+            cmpBit = readSlot();
+            searchStep = SearchStep::DIRECTION;
+            return true;
+        case SearchStep::DIRECTION: {
+            if (idBit && cmpBit) {
+                endSearch(false);  // no devices responded
+                return false;
+            }
+            const uint8_t byte = (bitNumber - 1) >> 3;
+            const uint8_t mask = 1 << ((bitNumber - 1) & 7);
+            bool direction;
+            if (idBit != cmpBit) {
+                direction = idBit;
+            } else {
+                // discrepancy: repeat the previous choice before the last discrepancy, pick 1 at it, 0 after it
+                direction = (bitNumber < lastDiscrepancy) ? (rom[byte] & mask) != 0 : bitNumber == lastDiscrepancy;
+                if (!direction) {
+                    lastZero = bitNumber;
+                }
+            }
+            if (direction) {
+                rom[byte] |= mask;
+            } else {
+                rom[byte] &= ~mask;
+            }
+            writeSlot(direction);
+            bitNumber++;
+            searchStep = (bitNumber > 64) ? SearchStep::DONE : SearchStep::ID_BIT;
+            return true;
+        }
+        case SearchStep::DONE:
+            endSearch(true);
+            return false;
+        }
+        return false;
+    }
+
+    bool loadNextOp() {
+        uint8_t o;
+        if (!commands.fastread(o)) {
+            return false;
+        }
+        op = Op(o);
+        bitMask = 0;
+        if (op == Op::WRITE || op == Op::READ) {
+            commands.fastread(bytesLeft);
+        } else if (op == Op::SEARCH) {
+            searchStep = SearchStep::RESET;
+        }
+        return true;
+    }
+
+    void nextSlot() {
+        for (;;) {
+            switch (op) {
+            case Op::NONE:
+                if (!loadNextOp()) {
+                    if (!power) {
+                        release();
+                    }
+                    comparator->interruptOff();
+                    phase = Phase::IDLE;
+                    return;
+                }
+                break;
+            case Op::RESET:
+                op = Op::NONE;
+                startReset();
+                return;
+            case Op::WRITE:
+                if (bitMask == 0) {
+                    if (bytesLeft == 0) {
+                        op = Op::NONE;
+                        break;
+                    }
+                    commands.fastread(current);
+                    bytesLeft--;
+                    bitMask = 1;
+                }
+                writeSlot(current & bitMask);
+                bitMask <<= 1;
+                return;
+            case Op::READ:
+                if (bitMask == 0) {
+                    if (bytesLeft == 0) {
+                        op = Op::NONE;
+                        break;
+                    }
+                    bytesLeft--;
+                    bitMask = 1;
+                    current = 0;
+                }
+                if (readSlot()) {
+                    current |= bitMask;
+                }
+                bitMask <<= 1;
+                if (bitMask == 0) {
+                    results.fastwrite(current);
+                }
+                return;
+            case Op::SEARCH:
+                if (searchSlot()) {
+                    return;
+                }
+                break;
+            }
+        }
+    }
+
+    void onComparator() {
+        if (waitLeft > 0) {
+            wait(waitLeft);
+            return;
+        }
+        switch (phase) {
+        case Phase::RESET_RELEASE:
+            release();
+            wait(presenceWait);
+            phase = Phase::RESET_SAMPLE;
+            break;
+        case Phase::RESET_SAMPLE:
+            present = pin->isLow();
+            if (op != Op::SEARCH) {
+                results.fastwrite(present ? 1 : 0);
+            }
+            wait(resetRecovery);
+            phase = Phase::NEXT;
+            break;
+        case Phase::WRITE0_RELEASE:
+            pin->setHigh();
+            wait(write0Recovery);
+            phase = Phase::NEXT;
+            break;
+        case Phase::NEXT:
+            nextSlot();
+            break;
+        case Phase::IDLE:
+            comparator->interruptOff();
+            break;
+        }
+    }
+
+    void start() {
+        AtomicScope _;
+        if (phase == Phase::IDLE) {
+            phase = Phase::NEXT;
+            waitLeft = 0;
+            comparator->setTarget(comparator->getValue() + count_t(write0Recovery));
+            comparator->interruptOn();
+        }
+    }
+
+    template <typename... types>
+    bool queue(types... args) {
+        if (commands.write(args...)) {
+            start();
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+public:
+    typedef On<This, typename comparator_t::INT, &This::onComparator> Handlers;
+
+    OneWireMaster(pin_t &p, comparator_t &c, bool _power): pin(&p), comparator(&c), power(_power) {
+        comparator->interruptOff();
+        release();
+    }
+
+    /** Queues a bus reset. Appends 1 to the results if any device is present, 0 otherwise. */
+    bool reset() {
+        return queue(uint8_t(Op::RESET));
+    }
+
+    /** Queues writing the given bytes, LSB first. */
+    template <typename... types>
+    bool write(types... args) {
+        AtomicScope _;
+        volatile uint8_t *count;
+        commands.writeStart();
+        if (!commands.write(uint8_t(Op::WRITE)) || !commands.reserve(count)) {
+            commands.writeAbort();
+            return false;
+        }
+        const uint8_t before = commands.getSpace();
+        if (!commands.write(args...)) {
+            commands.writeAbort();
+            return false;
+        }
+        *count = before - commands.getSpace();
+        commands.writeEnd();
+        start();
+        return true;
+    }
+
+    /** Queues selecting the device at [addr] for the next command. */
+    bool select(const OneWireAddress &addr) {
+        const uint8_t *a = addr.addr;
+        return write(MATCH_ROM, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+    }
+
+    /** Queues reading [count] bytes, which are appended to the results. */
+    bool read(uint8_t count) {
+        return queue(uint8_t(Op::READ), count);
+    }
+
+    /**
+     * Queues a search for the next device on the bus. Repeated searches return all connected devices,
+     * always in the same order, followed by a single "not found".
+     */
+    bool search() {
+        return queue(uint8_t(Op::SEARCH));
+    }
+
+    AbstractFifo::In in() {
+        return results.in();
+    }
+
+    /** Reads the result of a completed search() into [addr], returning whether a device was found. */
+    bool readSearchResult(OneWireAddress &addr) {
+        uint8_t found = 0;
+        if (!results.read(&found, &addr.addr[0], &addr.addr[1], &addr.addr[2], &addr.addr[3],
+                &addr.addr[4], &addr.addr[5], &addr.addr[6], &addr.addr[7])) {
+            return false;
+        }
+        return found != 0;
+    }
+
+    /** Returns whether all queued operations have completed. */
+    bool isIdle() const {
+        return phase == Phase::IDLE;
+    }
+
+    TaskState getTaskState() const {
+        return isIdle() ? TaskState::idle() : TaskState::busy(HAL::Atmel::SleepMode::IDLE);
+    }
+};
+
+} // namespace Impl
+
+/** Interrupt-driven OneWire master that keeps the bus driven high after writes, for parasite powered devices. */
+template <uint8_t commandFifoSize = 32, uint8_t resultFifoSize = 32, typename pin_t, typename comparator_t>
+Impl::OneWireMaster<pin_t, comparator_t, commandFifoSize, resultFifoSize> OneWireMasterParasitePower(pin_t &pin, comparator_t &comparator) {
+    return { pin, comparator, true };
+}
+
+template <uint8_t commandFifoSize = 32, uint8_t resultFifoSize = 32, typename pin_t, typename comparator_t>
+Impl::OneWireMaster<pin_t, comparator_t, commandFifoSize, resultFifoSize> OneWireMasterUnpowered(pin_t &pin, comparator_t &comparator) {
+    return { pin, comparator, false };
+}
+
+} // namespace Dallas
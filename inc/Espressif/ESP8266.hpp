@@ -11,6 +11,7 @@
 #include "ChunkedFifo.hpp"
 #include "EEPROM.hpp"
 #include "Streams/Scanner.hpp"
+#include "Streams/TokenMatcher.hpp"
 #include "Time/RealTimer.hpp"
 #include "Time/Units.hpp"
 #include "Espressif/EthernetMACAddress.hpp"
@@ -80,6 +81,15 @@ private:
     EthernetMACAddress mac;
     bool macKnown = false;
 
+    typedef STR("+IPD,") IPD;
+    typedef STR("SEND OK") SEND_OK;
+    typedef STR("ERROR") ERROR;
+    typedef STR("busy") BUSY;
+    typedef TokenMatcher<IPD, SEND_OK, ERROR, BUSY> SendReplies;
+    SendReplies sendReplies;
+    ReadProgress ipdProgress;
+    uint8_t ipdLength = 0;
+
     constexpr static auto COMMAND_TIMEOUT = 1_s;
     constexpr static auto CONNECT_TIMEOUT = 10_s;
     constexpr static auto IDLE_TIMEOUT = 5_min;
@@ -308,6 +318,8 @@ private:
                 txFifo.readStart();
                 if (tx->write(txFifo)) {
                     txFifo.readEnd();
+                    sendReplies.reset();
+                    ipdProgress.reset();
                     state = State::SENDING_DATA;
                     watchdog.schedule(CONNECT_TIMEOUT);
                 } else {
@@ -319,30 +331,34 @@ private:
     }
 
     void sending_data() {
-        scan(*rx, [this] (auto &read) {
-            uint8_t length;
+        switch (sendReplies.scan(*rx)) {
+        case SendReplies::id<IPD>(): {
             rxFifo.writeStart();
-            if (read(F("+IPD,"), Decimal(&length), F(":"), ChunkWithLength(&length, rxFifo))) {
-                //log::debug(F("send_in"));
+            const ReadResult result = rx->read(&ipdProgress, Decimal(&ipdLength), F(":"), ChunkWithLength(&ipdLength, rxFifo));
+            if (result == ReadResult::Valid) {
                 rxFifo.writeEnd();
                 watchdog.schedule(CONNECT_TIMEOUT);
-            } else if (read(F("SEND OK"))) {
-                //log::debug(F("send_ok"));
-                rxFifo.writeAbort();
-                state = State::CONNECTED_DELAY; // "we need to wait 20ms between packets..."
-                watchdog.schedule(SEND_DELAY);
-            } else if (read(F("ERROR"))) {
-                //log::debug(F("send_er"));
-                rxFifo.writeAbort();
-                state = State::CONNECTED;
-                watchdog.schedule(IDLE_TIMEOUT);
-            } else if (read(F("busy"))) { // the infamous "busy s..." out-of-sync error
-                //log::debug(F("busy"));
-                this->recycle();
             } else {
                 rxFifo.writeAbort();
+                if (result != ReadResult::Invalid) {
+                    // the packet hasn't fully arrived yet, continue with the same field next time
+                    sendReplies.unread(SendReplies::id<IPD>());
+                }
             }
-        });
+            break;
+        }
+        case SendReplies::id<SEND_OK>():
+            state = State::CONNECTED_DELAY; // "we need to wait 20ms between packets..."
+            watchdog.schedule(SEND_DELAY);
+            break;
+        case SendReplies::id<ERROR>():
+            state = State::CONNECTED;
+            watchdog.schedule(IDLE_TIMEOUT);
+            break;
+        case SendReplies::id<BUSY>(): // the infamous "busy s..." out-of-sync error
+            recycle();
+            break;
+        }
     }
 
     void doLoop() {
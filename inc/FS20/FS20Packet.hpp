@@ -17,24 +17,24 @@ using namespace Streams;
 using namespace Serial;
 
 struct FS20Packet {
-    static const uint8_t prefix[];
-    static const uint8_t postfix[];
-
     template <typename prescaled_t>
-    static constexpr SerialConfig serialConfig() {
-        using namespace Time;
+    struct SerialFormat {
+        static constexpr bool highOnIdle = false;
+        static constexpr uint8_t prefix_bits = 24;
+        static constexpr uint32_t prefix = 0x800000;
+        static constexpr uint8_t postfix_bits = 2;
+        static constexpr uint32_t postfix = 0b00;
+        static constexpr SerialParity parity = SerialParity::EVEN;
+        static constexpr SerialBitOrder bitOrder = SerialBitOrder::MSB_FIRST;
 
-        return SerialConfig {
-            /* highOnIdle */ false,
-            prefix, 24,
-            highPulseOn<prescaled_t>(400_us),
-            lowPulseOn<prescaled_t>(400_us),
-            highPulseOn<prescaled_t>(600_us),
-            lowPulseOn<prescaled_t>(600_us),
-            SerialParity::EVEN,
-            SerialBitOrder::MSB_FIRST,
-            postfix, 2 };
-    }
+        static constexpr Pulse zero_a() { return highPulseOn<prescaled_t>(400_us); }
+        static constexpr Pulse zero_b() { return lowPulseOn<prescaled_t>(400_us); }
+        static constexpr Pulse one_a() { return highPulseOn<prescaled_t>(600_us); }
+        static constexpr Pulse one_b() { return lowPulseOn<prescaled_t>(600_us); }
+    };
+
+    template <typename prescaled_t>
+    using serialConfig = SerialConfig<SerialFormat<prescaled_t>>;
 
     uint8_t houseCodeHi = 0;
     uint8_t houseCodeLo = 0;
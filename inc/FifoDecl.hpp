@@ -145,6 +145,25 @@ public:
      */
     bool reserve(volatile uint8_t * &ptr);
 
+    /**
+     * Invokes [f] with every byte that has been written after [ptr], which must have been returned by reserve()
+     * during the current write. This allows a writer to calculate e.g. a checksum over data it has just written.
+     */
+    template <typename lambda_t>
+    void forEachWrittenAfter(volatile uint8_t *ptr, lambda_t f) const {
+        uint8_t pos = (ptr - buffer) + 1;
+        if (pos >= bufferSize) {
+            pos -= bufferSize;
+        }
+        while (pos != writePos) {
+            f(buffer[pos]);
+            pos++;
+            if (pos >= bufferSize) {
+                pos -= bufferSize;
+            }
+        }
+    }
+
     /**
      * Reads a value from the fifo, assuming that previously a check to getSize() was made,
      * and nothing else was read in the meantime.
@@ -178,6 +197,32 @@ public:
         return avail;
     }
 
+    /**
+     * Only for use in interrupts, or by a single reader. Force inlined, and does not disable interrupt flag.
+     * Returns the number of bytes that can be read contiguously from [ptr] onwards, without wrapping around.
+     * The bytes keep occupying space until they're released by fastSkip().
+     */
+    __attribute__((always_inline)) inline uint8_t fastReadSpan(volatile uint8_t * &ptr) const {
+        const uint8_t write_pos = markedOrWritePos();
+        const uint8_t read_pos = readPos;
+        ptr = buffer + read_pos;
+        return (write_pos >= read_pos) ? write_pos - read_pos : bufferSize - read_pos;
+    }
+
+    /** Only for use in interrupts. Releases [count] bytes previously obtained through fastReadSpan(). */
+    __attribute__((always_inline)) inline void fastSkip(uint8_t count) {
+        uint8_t pos = readPos + count;
+        if (pos >= bufferSize) {
+            pos -= bufferSize;
+        }
+        readPos = pos;
+    }
+
+    /** Only for use in interrupts, or by a single writer. Force inlined, and does not disable interrupt flag. */
+    __attribute__((always_inline)) inline bool fastIsFull() const {
+        return _isFull();
+    }
+
     /** Only for use in interrupts. Force inlined, and does not disable interrupt flag. */
     __attribute__((always_inline)) inline uint8_t fastGetSpace() {
     	return _getSpace();
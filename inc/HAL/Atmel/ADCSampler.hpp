@@ -0,0 +1,182 @@
+#pragma once
+
+#include "HAL/Atmel/ADConverter.hpp"
+#include "HAL/Atmel/InterruptHandlers.hpp"
+#include "Time/Units.hpp"
+#include "AtomicScope.hpp"
+#include <stdint.h>
+
+namespace HAL {
+namespace Atmel {
+
+namespace Impl {
+
+using namespace Time;
+
+/**
+ * A single, possibly oversampled, A/D reading as stored by ADCSampler.
+ */
+struct ADCSample {
+    /** Index of the channel in ADCSampler's pin list */
+    uint8_t channel;
+    /** The 10-bit conversion result, averaged over all oversampled conversions */
+    uint16_t value;
+};
+
+/**
+ * Samples a fixed list of analog pins without any involvement of loop(). Conversions are auto-triggered by
+ * [comparator_t] matching, which the ADC interrupt moves ahead by one period each time. The interrupt also sums up
+ * 2^[oversampleShift] conversions of the same channel, after which it stores their average into a ring buffer of
+ * [bufferSize] samples and moves on to the next pin.
+ *
+ * Only comparators that can act as ADC trigger source can be used (Timer0 comparator A or Timer1 comparator B).
+ * The comparator's interrupt is not used, so it doesn't need to be enabled.
+ */
+template <typename comparator_t, uint8_t bufferSize, uint8_t oversampleShift, typename... pins_t>
+class ADCSampler {
+    typedef ADCSampler<comparator_t, bufferSize, oversampleShift, pins_t...> This;
+    typedef typename comparator_t::value_t count_t;
+
+    static_assert(sizeof...(pins_t) > 0, "At least one pin should be sampled");
+    static_assert(oversampleShift <= 6, "The sum of more than 64 10-bit conversions won't fit 16 bits");
+
+    static constexpr uint8_t channelCount = sizeof...(pins_t);
+    static constexpr uint8_t oversample = 1 << oversampleShift;
+    static constexpr uint8_t muxes[channelCount] = { decltype(pins_t::info_t::adc_mux)::bitMask... };
+
+    comparator_t * const comparator;
+    const count_t period;
+
+    volatile uint8_t channels[bufferSize];
+    volatile uint16_t values[bufferSize];
+    volatile uint8_t head = 0;
+    volatile uint8_t tail = 0;
+    volatile uint8_t overflows = 0;
+    volatile uint16_t latest[channelCount] = {};
+
+    uint16_t sum = 0;
+    uint8_t taken = 0;
+    uint8_t channel = 0;
+
+    static uint8_t next(uint8_t idx) {
+        return (idx + 1 < bufferSize) ? idx + 1 : 0;
+    }
+
+    static void selectChannel(uint8_t idx) {
+        ADMUX.val() = (ADMUX.val() & 0xF0) | muxes[idx];
+    }
+
+    void store(uint16_t value) {
+        latest[channel] = value;
+        const uint8_t h = head;
+        const uint8_t n = next(h);
+        if (n == tail) {
+            overflows++;
+        } else {
+            channels[h] = channel;
+            values[h] = value;
+            head = n;
+        }
+    }
+
+    void onComplete() {
+        comparator->clearMatch();
+        comparator->setTarget(comparator->getTarget() + period);
+
+        sum += ADC.get();
+        taken++;
+        if (taken >= oversample) {
+            store(sum >> oversampleShift);
+            sum = 0;
+            taken = 0;
+            if (channelCount > 1) {
+                channel = (channel + 1 < channelCount) ? channel + 1 : 0;
+                selectChannel(channel);
+            }
+        }
+    }
+
+public:
+    typedef On<This, Int_ADC_, &This::onComplete> Handlers;
+
+    ADCSampler(comparator_t &c, count_t p, ADReference reference): comparator(&c), period(p) {
+        BaseADC::setReference(reference);
+        ADLAR.clear();
+#if (F_CPU == 16000000)
+        // Set ADC prescaler to 128: 125kHz ADC clock, up to 9.6kHz conversions @ 16MHz
+        ADPS2.set();
+        ADPS1.set();
+        ADPS0.set();
+#endif
+        selectChannel(0);
+        ADCSRB.apply(comparator_t::comparator_info_t::ADTS);
+        start();
+    }
+
+    ~ADCSampler() {
+        stop();
+    }
+
+    /** Starts sampling, which the constructor already does. */
+    void start() {
+        AtomicScope _;
+        comparator->setTarget(comparator->getValue() + period);
+        comparator->clearMatch();
+        ADIE.set();
+        ADATE.set();
+        ADEN.set();
+    }
+
+    /** Stops triggering conversions. Samples that are still in the buffer can be read. */
+    void stop() {
+        ADATE.clear();
+        ADIE.clear();
+    }
+
+    /** Pops the oldest sample into [sample], returning false if no sample is available. */
+    bool read(ADCSample &sample) {
+        const uint8_t t = tail;
+        if (t == head) {
+            return false;
+        }
+        sample.channel = channels[t];
+        sample.value = values[t];
+        tail = next(t);
+        return true;
+    }
+
+    /** Returns the most recent sample of the channel at [idx], regardless of whether it was read from the buffer. */
+    uint16_t getLatest(uint8_t idx) const {
+        AtomicScope _;
+        return latest[idx];
+    }
+
+    /** Returns the number of samples that were dropped because the buffer was full. */
+    uint8_t getOverflows() const {
+        return overflows;
+    }
+};
+
+template <typename comparator_t, uint8_t bufferSize, uint8_t oversampleShift, typename... pins_t>
+constexpr uint8_t ADCSampler<comparator_t, bufferSize, oversampleShift, pins_t...>::muxes[];
+
+}
+
+/**
+ * Creates an ADCSampler that cycles through [pins] once every [period] per conversion, e.g.
+ *
+ *     auto adc = adcSampler<2>(timer0.comparatorA(), 250_us, pinA0, pinA1);
+ *
+ * takes 4 conversions of each pin in turn, yielding 1000 samples per second in total.
+ */
+template <uint8_t oversampleShift = 0, uint8_t bufferSize = 16, typename comparator_t, typename period_t, typename... pins_t>
+Impl::ADCSampler<comparator_t, bufferSize, oversampleShift, pins_t...> adcSampler(comparator_t &comparator, period_t period, pins_t &... pins) {
+    typedef typename comparator_t::value_t count_t;
+    constexpr uint64_t counts = uint64_t(Time::toCountsOn<comparator_t, period_t>().getValue());
+    static_assert(counts > 0, "The period should be at least one timer count");
+    static_assert(counts <= count_t(-1), "The period should fit the comparator");
+    return { comparator, count_t(counts), ADReference::AVCC };
+}
+
+}
+}
@@ -11,6 +11,7 @@
 #include <HAL/Atmel/Registers.hpp>
 #include <HAL/Atmel/InterruptHandlers.hpp>
 #include "AtomicScope.hpp"
+#include "Tasks/TaskState.hpp"
 #include <stdint.h>
 
 namespace HAL {
@@ -34,9 +35,11 @@ using namespace InterruptHandlers;
 
 class BaseADC {
     volatile bool newValue = false;
+    volatile bool pending = false;
 
     void onComplete() {
         newValue = true;
+        pending = false;
     }
 
     template <typename pin_t>
@@ -44,6 +47,12 @@ class BaseADC {
       ADMUX.apply(pin_t::info_t::adc_mux);
     }
 
+protected:
+    /**
+     * Waits for the current conversion to complete, in ADC noise reduction sleep if interrupts are enabled.
+     */
+    void awaitConversion();
+
 public:
     typedef On<BaseADC, Int_ADC_, &BaseADC::onComplete> Handlers;
     /**
@@ -62,7 +71,7 @@ public:
      */
     void enable();
 
-    void setReference(ADReference ref);
+    static void setReference(ADReference ref);
 
     template <typename pin_t>
     void measure(pin_t pin) {
@@ -72,6 +81,7 @@ public:
     template <typename pin_t>
     void measure() {
         selectPin<pin_t>();
+        pending = true;
         ADCSRA |= ADSC;  // Start A2D Conversion
     }
 
@@ -86,6 +96,18 @@ public:
         ADCSRA |= ADATE; //enabble auto trigger
         ADCSRA |= ADSC;  // Start A2D Conversion
     }
+
+    /**
+     * Allows ADC noise reduction sleep while a single conversion started by measure() is pending, so the
+     * conversion completes with the CPU and I/O clocks halted.
+     */
+    TaskState getTaskState() const {
+        if (pending) {
+            return TaskState::busy(SleepMode::ADC);
+        } else {
+            return TaskState::idle();
+        }
+    }
 };
 
 }
@@ -110,7 +132,7 @@ public:
     }
 
     uint16_t awaitValue(){
-        while (ADSC.isSet()) ;
+        awaitConversion();
         return getValue();
     }
 
@@ -139,7 +161,7 @@ public:
     }
 
     uint8_t awaitValue() {
-        while (ADSC.isSet()) ;
+        awaitConversion();
         return getValue();
     }
 
@@ -85,6 +85,12 @@ class Power {
         	log::flush();
         }
 
+        if (mode == SleepMode::ADC) {
+            // A conversion is far shorter than any watchdog interval, and its interrupt will wake us up.
+            sleep(mode);
+            return true;
+        }
+
         bool interrupted = false;
         uint32_t millisSleep = ms.getValue();
         if (millisSleep <= 16) {
@@ -7,12 +7,18 @@ namespace Atmel {
 
 enum class SleepMode: uint8_t {
     /** Lowest power mode. */
-    POWER_DOWN = 2,
+    POWER_DOWN = 3,
     /**
      * Like POWER_DOWN, but leaves the oscillator running so resuming is (a lot) faster. Use this if you're expecting
      * serial or SPI data to come in via interrupts that you need to quickly read in.
      */
-    STANDBY = 1,
+    STANDBY = 2,
+    /**
+     * ADC noise reduction: halts the CPU and I/O clocks, but keeps the A/D converter running. This gives more
+     * accurate conversions, and the ADC interrupt wakes up the CPU once the conversion is done. Timers 0 and 1
+     * stop counting while in this mode.
+     */
+    ADC = 1,
     /**
      * Least power savings, basically only halts the CPU and Flash. But this is the only sleep mode
      * where PWM keeps running.
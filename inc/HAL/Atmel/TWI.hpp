@@ -3,14 +3,80 @@
 
 #include "HAL/Atmel/InterruptHandlers.hpp"
 #include "Fifo.hpp"
-#include "ChunkedFifo.hpp"
 #include "Logging.hpp"
 
 namespace HAL {
 namespace Atmel {
-namespace Impl {
 
-enum class TWIState { IDLE, WRITING, READING };
+enum class TWIStatus: uint8_t { IDLE, PENDING, DONE, FAILED };
+
+/**
+ * Completion state of a queued TWI transaction, and the bytes it has read. The TWI interrupt appends
+ * received bytes and then marks the result DONE or FAILED, so callers can poll it (e.g. from a TaskState loop)
+ * instead of blocking on the bus.
+ */
+class AbstractTWIResult {
+    volatile TWIStatus status = TWIStatus::IDLE;
+    AbstractFifo * const fifo;
+
+protected:
+    AbstractTWIResult(AbstractFifo &f): fifo(&f) {}
+
+public:
+    TWIStatus getStatus() const {
+        return status;
+    }
+
+    bool isPending() const {
+        return status == TWIStatus::PENDING;
+    }
+
+    bool isDone() const {
+        return status == TWIStatus::DONE;
+    }
+
+    bool isFailed() const {
+        return status == TWIStatus::FAILED;
+    }
+
+    /** Reads the received bytes, which is only valid once the transaction is done. */
+    template <typename... types>
+    Streams::ReadResult read(types... args) {
+        if (status != TWIStatus::DONE) {
+            return Streams::ReadResult::type::Invalid;
+        }
+        return fifo->read(args...);
+    }
+
+    /** Invoked by the bus when the transaction is queued. */
+    void start() {
+        fifo->clear();
+        status = TWIStatus::PENDING;
+    }
+
+    /** Invoked by the bus from its interrupt, for every received byte. */
+    __attribute__((always_inline)) inline void append(uint8_t b) {
+        fifo->fastwrite(b);
+    }
+
+    /** Invoked by the bus from its interrupt, when the transaction has ended. */
+    void complete(TWIStatus s) {
+        status = s;
+    }
+};
+
+/** Result of a queued TWI transaction that reads up to [size] bytes. Copies start out idle. */
+template <uint8_t size>
+class TWIResult: public AbstractTWIResult {
+    Fifo<size> data;
+public:
+    static constexpr uint8_t capacity = size;
+
+    TWIResult(): AbstractTWIResult(data) {}
+    TWIResult(const TWIResult &): AbstractTWIResult(data) {}
+};
+
+namespace Impl {
 
 using namespace HAL::Atmel::InterruptHandlers;
 using namespace HAL::Atmel::Registers;
@@ -18,8 +84,13 @@ using namespace Streams;
 
 /**
  * Hardware Atmel TWI support. Based off the arduino libraries.
+ *
+ * Every write or read is queued as a transaction of: address, bytes to write (kept in the tx fifo), number of
+ * bytes to read, and an optional result to store them in. If a transaction both writes and reads, the read
+ * follows the write using a repeated start. The interrupt runs all queued transactions back to back, so drivers
+ * can queue a chain of register reads and sleep until their results are done.
  */
-template <typename info_t, uint8_t txFifoSize, uint8_t rxFifoSize, uint32_t twiFreq>
+template <typename info_t, uint8_t txFifoSize, uint8_t rxFifoSize, uint32_t twiFreq, uint8_t queueSize = 8>
 class TWI {
 	static constexpr uint8_t TW_START = 0x08;
 	static constexpr uint8_t TW_REP_START = 0x10;
@@ -42,25 +113,49 @@ class TWI {
 		return TWSR.get() & (TWS3 | TWS4 | TWS5 | TWS6 | TWS7);
 	}
 
-    typedef TWI<info_t, txFifoSize,rxFifoSize,twiFreq> This;
+    typedef TWI<info_t, txFifoSize, rxFifoSize, twiFreq, queueSize> This;
     typedef Logging::Log<Loggers::TWI> log;
 
-    Fifo<txFifoSize> txFifoData;
-    ChunkedFifo txFifo;// = { txFifoData };
-    Fifo<rxFifoSize> rxFifoData;
-    ChunkedFifo rxFifo;// = { rxFifoData };
-    volatile uint8_t readExpected = 0;
-public:
-    static constexpr uint32_t frequency = twiFreq;
+    struct Transaction {
+        uint8_t address;
+        uint8_t writeCount;
+        uint8_t readCount;
+        AbstractTWIResult *result;
+    };
 
-    volatile uint8_t ints = 0;
+    Fifo<txFifoSize> txFifo;
+    Transaction queue[queueSize];
+    volatile uint8_t queueHead = 0;
+    volatile uint8_t queueTail = 0;
 
-    static volatile bool transceiving;
-    static void startWriting() {
-    	log::debug(F("go!"), '0' + transceiving, ' ', dec(TWCR));
-        if (!transceiving) {
+    volatile uint8_t writeLeft = 0;
+    volatile uint8_t readLeft = 0;
+    volatile uint8_t errors = 0;
+
+    /** Receives the bytes for the blocking read() */
+    TWIResult<rxFifoSize> readResult;
+
+    static uint8_t next(uint8_t pos) {
+        return (pos + 1 < queueSize) ? pos + 1 : 0;
+    }
+
+    bool isQueueFull() const {
+        return next(queueTail) == queueHead;
+    }
+
+    Transaction &current() {
+        return queue[queueHead];
+    }
+
+    /** Starts the transaction at the head of the queue, if any. To be called with interrupts disabled. */
+    void startNext() {
+        if (queueHead != queueTail) {
             transceiving = true;
+            writeLeft = current().writeCount;
+            readLeft = current().readCount;
             TWCR = TWEN | TWIE | TWEA | TWINT | TWSTA;
+        } else {
+            transceiving = false;
         }
     }
 
@@ -72,6 +167,14 @@ public:
         TWCR = TWEN | TWIE | TWINT;
     }
 
+    void replyAckIfMoreThanOneLeft() {
+        if (readLeft > 1) {
+            replyAck();
+        } else {
+            replyNack();
+        }
+    }
+
     void stop() {
         TWCR = TWEN | TWIE | TWEA | TWINT | TWSTO;
 
@@ -79,111 +182,88 @@ public:
         // TWINT is not set after a stop condition!
         uint16_t maxWait = 65000;
         while (maxWait > 0 && TWSTO.isSet()) maxWait--;
-
-        txFifo.readEnd();
-        rxFifo.writeEnd();
-        readExpected = 0;
-        transceiving = false;
-        log::debug(F("stop"));
     }
 
     void releaseBus() {
         TWCR = TWEN | TWIE | TWEA | TWINT;
-        txFifo.readEnd();
-        rxFifo.writeEnd();
-        readExpected = 0;
-        transceiving = false;
-        log::debug(F("rel"));
+    }
+
+    void store(uint8_t b) {
+        if (current().result) {
+            current().result->append(b);
+        }
+    }
+
+    /** Completes the current transaction, and moves on to the next one. The bus must already be stopped or released. */
+    void complete(TWIStatus status) {
+        if (status != TWIStatus::DONE) {
+            errors++;
+        }
+        txFifo.fastSkip(writeLeft);  // any bytes left unsent when the slave NACKed
+        if (current().result) {
+            current().result->complete(status);
+        }
+        queueHead = next(queueHead);
+        startNext();
+    }
+
+    void sendNextByteOrContinue() {
+        if (writeLeft > 0) {
+            uint8_t b;
+            txFifo.fastread(b);
+            writeLeft--;
+            TWDR.set(b);
+            replyAck();
+        } else if (readLeft > 0) {
+            TWCR = TWEN | TWIE | TWEA | TWINT | TWSTA;  // repeated start, into master receiver mode
+        } else {
+            stop();
+            complete(TWIStatus::DONE);
+        }
     }
 
     void onTWI() {
-    	ints++;
-    	//log::debug('t',':',dec(TW_STATUS));
         switch(TW_STATUS()) {
         // All Master
     case TW_START:     // sent start condition
     case TW_REP_START: // sent repeated start condition
-      // copy device address and r/w bit to output register and ack
-    	uint8_t c;
-    	c = txFifo.hasContent();
-        txFifo.readStart();
-    	uint8_t avail;
-    	avail = txFifo.getReadAvailable();
-        uint8_t address_and_rw_bit;
-        txFifo.read(&address_and_rw_bit);
-        log::debug('>',dec(address_and_rw_bit),',',dec(avail),',','0'+c);
-        //log::debug(dec(uint16_t(&txFifo)));
-        TWDR.set(address_and_rw_bit); // twi_slarw;
+        // a repeated start is only sent once all bytes are written, so it always is for reading
+        TWDR.set(uint8_t((current().address << 1) | ((writeLeft > 0 || readLeft == 0) ? TW_WRITE : TW_READ)));
         replyAck();
       break;
 
     // Master Transmitter
     case TW_MT_SLA_ACK:  // slave receiver acked address
-        log::debug(F("TW_MT_SLA_ACK"));
-        if (txFifo.hasReadAvailable()) {
-            uint8_t b;
-            txFifo.read(&b);
-            TWDR.set(b);
-            replyAck();
-        } else {
-            stop();
-        }
-      break;
     case TW_MT_DATA_ACK: // slave receiver acked data
-        log::debug(F("TW_MT_DATA_ACK"));
-        if (txFifo.hasReadAvailable()) {
-            uint8_t b;
-            txFifo.read(&b);
-            TWDR.set(b);
-            replyAck();
-        } else {
-            stop();
-        }
+        sendNextByteOrContinue();
       break;
     case TW_MT_SLA_NACK:  // address sent, nack received
-      log::debug(F("TW_MT_SLA_NACK"));
-      stop();
-      break;
     case TW_MT_DATA_NACK: // data sent, nack received
-      log::debug(F("TW_MT_DATA_NACK"));
+    case TW_MR_SLA_NACK: // address sent, nack received
       stop();
+      complete(TWIStatus::FAILED);
       break;
     case TW_MT_ARB_LOST: // lost bus arbitration
-      log::debug(F("TW_MT_ARB_LOST"));
       releaseBus();
+      complete(TWIStatus::FAILED);
       break;
 
     // Master Receiver
-    case TW_MR_DATA_ACK: // data received, ack sent
-      log::debug(F("TW_MR_DATA_ACK "), dec(TWDR.get()),' ', dec(readExpected));
-      // put byte into buffer
-      rxFifo.write(TWDR.get());
-        if (readExpected > 1) {
-            readExpected--;
-            replyAck();
-        } else {
-            readExpected = 0;
-            replyNack();
-        }
-        break;
     case TW_MR_SLA_ACK:  // address sent, ack received
-      log::debug(F("TW_MR_SLA_ACK "), ' ', dec(readExpected));
       // ack if more bytes are expected, otherwise nack
-        if (readExpected > 0) {
-            replyAck();
-        } else {
-            replyNack();
-        }
-        break;
+      replyAckIfMoreThanOneLeft();
+      break;
+    case TW_MR_DATA_ACK: // data received, ack sent
+      store(TWDR.get());
+      readLeft--;
+      replyAckIfMoreThanOneLeft();
+      break;
     case TW_MR_DATA_NACK: // data received, nack sent
-      log::debug(F("TW_MR_DATA_NACK "), dec(TWDR.get()), dec(readExpected));
       // put final byte into buffer
-        rxFifo.write(TWDR.get());
-        stop();
-        break;
-    case TW_MR_SLA_NACK: // address sent, nack received
-        log::debug(F("TW_MR_SLA_NACK"));
-        stop();
+      store(TWDR.get());
+      readLeft = 0;
+      stop();
+      complete(TWIStatus::DONE);
       break;
     // TW_MR_ARB_LOST handled by TW_MT_ARB_LOST case
 
@@ -272,16 +352,19 @@ public:
     case TW_NO_INFO:   // no state information
       break;
     case TW_BUS_ERROR: // bus error, illegal stop/start
-      log::debug(F("TW_BUS_ERROR"));
       stop();
+      complete(TWIStatus::FAILED);
       break;
         }
     }
 public:
+    static constexpr uint32_t frequency = twiFreq;
+
+    static volatile bool transceiving;
+
     typedef On<This, HAL::Atmel::Int_TWI_, &This::onTWI> Handlers;
 
-    TWI(): txFifo(txFifoData), rxFifo(rxFifoData) {
-    	//log::debug('s', dec(txFifo.getSize()), 'p', dec(txFifo.getSpace()));
+    TWI() {
         transceiving = false;
 
         // switch to input, without pull up for now
@@ -311,45 +394,58 @@ public:
     	return transceiving;
     }
 
-    template <typename... types>
-    bool write(uint8_t address, types... args) {
-        return writeIfSpace(address, args...);
+    /** Returns the number of transactions that failed, since the slave did not acknowledge or the bus was lost. */
+    uint8_t getErrors() const {
+        return errors;
     }
 
-    /* TODO re-enable this by switching away from ChunkedFifo, and having some other means of telling whether done.
-     * This is because we can't read from a ChunkedFifo while also writing to it. So the TxFifo would need to become
-     * an ordinary fifo. Perhaps combined with a "stillWriting" flag?
+    /**
+     * Queues a transaction that writes [args] to [address], and then reads [readCount] bytes into [result] after
+     * a repeated start. [result] may be null when not reading. Returns false if the queue or tx fifo is full, or
+     * [result] still is pending from an earlier transaction.
+     */
     template <typename... types>
-    void writeOrBlock(uint8_t address, types... args) {
-        txFifo.template writeOrBlockWith<&This::startWriting>(uint8_t(TW_WRITE | (address << 1)), args...);
-
+    bool transceive(uint8_t address, AbstractTWIResult *result, uint8_t readCount, types... args) {
         AtomicScope _;
-        if (txFifo.hasContent()) {
-            startWriting();
+
+        if (isQueueFull() || (result && result->isPending())) {
+            return false;
+        }
+        const uint8_t before = txFifo.getSpace();
+        if (!txFifo.write(args...)) {
+            return false;
         }
+        if (result) {
+            result->start();
+        }
+        queue[queueTail] = { address, uint8_t(before - txFifo.getSpace()), readCount, result };
+        queueTail = next(queueTail);
+        if (!transceiving) {
+            startNext();
+        }
+        return true;
     }
-    */
 
     template <typename... types>
-    bool writeIfSpace(uint8_t address, types... args) {
-    	log::debug('s', dec(txFifo.getSize()), 'p', dec(txFifo.getSpace()), 'c', dec(txFifo.getCapacity()));
-        bool result = txFifo.writeIfSpace(uint8_t(TW_WRITE | (address << 1)), args...);
-        log::debug('w', dec(address), 'c', '0' + txFifo.hasContent(), 's', dec(txFifo.getSize()));
-        //log::debug(dec(uint16_t(&txFifo)));
-
-        txFifo.readStart();
-    	uint8_t avail;
-    	avail = txFifo.getReadAvailable();
-        txFifo.readAbort();
+    bool write(uint8_t address, types... args) {
+        return transceive(address, nullptr, 0, args...);
+    }
 
-        log::debug('a', dec(avail));
+    template <typename... types>
+    bool writeIfSpace(uint8_t address, types... args) {
+        return write(address, args...);
+    }
 
-        AtomicScope _;
-        if (txFifo.hasContent()) {
-            startWriting();
-        }
+    /** Queues reading [size] bytes from register [reg] of [address], using a repeated start after writing [reg]. */
+    template <uint8_t size>
+    bool readRegister(uint8_t address, uint8_t reg, TWIResult<size> &result) {
+        return transceive(address, &result, size, reg);
+    }
 
-        return result;
+    /** Queues reading [size] bytes from [address], without writing a register first. */
+    template <uint8_t size>
+    bool readInto(uint8_t address, TWIResult<size> &result) {
+        return transceive(address, &result, size);
     }
 
     void flush() {
@@ -365,35 +461,27 @@ public:
       }
     }
 
+    /** Blocks until all queued transactions are done, and then reads from [address] into [args]. */
     template <typename... types>
     ReadResult read(uint8_t address, types... args) {
       if (SREG_I.isCleared()) {
         // We need interrupts in order to be able to read.
         return ReadResult::type::Invalid;
       }
-      flush();
-      if (transceiving) {
+      constexpr uint8_t size = Streams::StreamedSize<types...>::fixedSizeReading;
+      static_assert(size <= rxFifoSize, "rxFifoSize is too small for this read");
+
+      if (!transceive(address, &readResult, size)) {
         log::debug(F("not connected"));
         return ReadResult::type::Invalid;
       }
-
-        readExpected = Streams::StreamedSize<types...>::fixedSizeReading;
-        log::debug(F("read start: "), dec(readExpected));
-        rxFifo.clear();
-        rxFifo.writeStart();
-        if (txFifo.write(uint8_t(TW_READ | (address << 1)))) {
-        	startWriting();
-        } else {
-          return ReadResult::type::Invalid;
-        }
-        flush();
-        log::debug(F("read: "), dec(rxFifo.getSize()));
-        return rxFifo.read(args...);
+      flush();
+      return readResult.read(args...);
     }
 };
 
-template <typename info_t, uint8_t txFifoSize, uint8_t rxFifoSize, uint32_t twiFreq>
-volatile bool TWI<info_t,txFifoSize,rxFifoSize,twiFreq>::transceiving = false;
+template <typename info_t, uint8_t txFifoSize, uint8_t rxFifoSize, uint32_t twiFreq, uint8_t queueSize>
+volatile bool TWI<info_t,txFifoSize,rxFifoSize,twiFreq,queueSize>::transceiving = false;
 
 }
 }
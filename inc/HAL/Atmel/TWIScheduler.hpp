@@ -0,0 +1,245 @@
+#pragma once
+
+#include "HAL/Atmel/TWI.hpp"
+#include "Time/RealTimer.hpp"
+#include "Tasks/TaskState.hpp"
+#include "Time/UnitLiterals.hpp"
+#include "Option.hpp"
+
+namespace HAL {
+namespace Atmel {
+
+namespace Impl {
+
+using namespace Time;
+
+/**
+ * Owns a TWI bus with several periodically measured devices, so that they share CPU wakeups instead of
+ * each running its own deadline:
+ *
+ * - Once any measurement is due, all measurements that are due within [window] are started together, in order
+ *   of decreasing conversion time.
+ * - Reads of measurements started together are postponed to the longest conversion time within [window] of their
+ *   own, so the results are all read in one wakeup.
+ *
+ * In addition, startScan() probes all 7-bit addresses for an ACK, one at a time from loop().
+ */
+template <typename twi_t, typename rt_t, uint8_t maxDevices>
+class TWIScheduler {
+    static constexpr uint8_t firstAddress = 0x08;
+    static constexpr uint8_t lastAddress = 0x77;
+    static constexpr uint8_t maxReadCount = 4;
+
+    enum class State: uint8_t { WAITING, CONVERTING, READING };
+
+    struct Device {
+        uint8_t address;
+        uint8_t command;
+        uint8_t readCount;
+        uint32_t conversion;
+        uint32_t interval;
+        State state;
+        bool fresh;
+        uint32_t started;
+        uint32_t due;
+        TWIResult<maxReadCount> result;
+    };
+
+    twi_t * const twi;
+    rt_t * const rt;
+    const uint32_t window;
+    Device devices[maxDevices];
+    uint8_t count = 0;
+
+    TWIResult<1> probe;
+    uint8_t scanAddress = 0;
+    bool probing = false;
+    uint8_t present[16] = {};
+
+    static bool isDue(const Device &d, uint32_t now, uint32_t slack = 0) {
+        return int32_t(d.due - now - slack) <= 0;
+    }
+
+    template <typename duration_t>
+    static uint32_t toCounts(duration_t duration) {
+        return toCountsOn<rt_t>(duration).getValue();
+    }
+
+    void finishReads() {
+        for (uint8_t i = 0; i < count; i++) {
+            Device &d = devices[i];
+            if (d.state == State::READING && !d.result.isPending()) {
+                d.fresh = d.result.isDone();
+                d.state = State::WAITING;
+            }
+        }
+    }
+
+    bool isAnyDue(uint32_t now) const {
+        for (uint8_t i = 0; i < count; i++) {
+            if (devices[i].state != State::READING && isDue(devices[i], now)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Returns the waiting device, due within the window, with the longest conversion time, or count if none. */
+    uint8_t nextToStart(uint32_t now) const {
+        uint8_t best = count;
+        for (uint8_t i = 0; i < count; i++) {
+            const Device &d = devices[i];
+            if (d.state == State::WAITING && isDue(d, now, window) &&
+                (best == count || d.conversion > devices[best].conversion)) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    void startConversions(uint32_t now) {
+        uint32_t readAfter = 0;
+        for (uint8_t i = nextToStart(now); i < count; i = nextToStart(now)) {
+            Device &d = devices[i];
+            if (!twi->write(d.address, d.command)) {
+                return;  // bus queue is full, the remaining ones are started on a next loop
+            }
+            if (readAfter == 0 || readAfter - d.conversion > window) {
+                readAfter = d.conversion;
+            }
+            d.state = State::CONVERTING;
+            d.started = now;
+            d.due = now + readAfter;
+        }
+    }
+
+    void readConversions(uint32_t now) {
+        for (uint8_t i = 0; i < count; i++) {
+            Device &d = devices[i];
+            if (d.state == State::CONVERTING && isDue(d, now)) {
+                if (!twi->transceive(d.address, &d.result, d.readCount)) {
+                    return;
+                }
+                d.state = State::READING;
+                d.fresh = false;
+                d.due = d.started + d.interval;
+            }
+        }
+    }
+
+    void scanStep() {
+        if (probing) {
+            if (probe.isPending()) {
+                return;
+            }
+            if (probe.isDone()) {
+                present[scanAddress >> 3] |= (1 << (scanAddress & 7));
+            }
+            probing = false;
+            scanAddress = (scanAddress < lastAddress) ? scanAddress + 1 : 0;
+        }
+        if (scanAddress != 0) {
+            probing = twi->transceive(scanAddress, &probe, 0);
+        }
+    }
+
+public:
+    template <typename window_t>
+    TWIScheduler(twi_t &t, rt_t &r, window_t w): twi(&t), rt(&r), window(toCounts(w)) {}
+
+    /**
+     * Adds a periodic measurement, in which writing [command] to [address] starts a conversion, after which
+     * [readCount] bytes are read back. It is first started on the next loop(). Returns the slot to read its
+     * results with, or none() if all slots are taken.
+     */
+    template <typename conversion_t, typename interval_t>
+    Option<uint8_t> add(uint8_t address, uint8_t command, uint8_t readCount, conversion_t conversion, interval_t interval) {
+        if (count >= maxDevices || readCount > maxReadCount) {
+            return none();
+        }
+        Device &d = devices[count];
+        d.address = address;
+        d.command = command;
+        d.readCount = readCount;
+        d.conversion = toCounts(conversion);
+        d.interval = toCounts(interval);
+        d.state = State::WAITING;
+        d.fresh = false;
+        d.due = rt->counts();
+        return count++;
+    }
+
+    /** Starts probing all addresses for devices. Results are available once isScanning() returns false. */
+    void startScan() {
+        for (auto &b: present) b = 0;
+        scanAddress = firstAddress;
+        probing = false;
+    }
+
+    bool isScanning() const {
+        return scanAddress != 0;
+    }
+
+    /** Returns whether [address] acknowledged during the last scan. */
+    bool isPresent(uint8_t address) const {
+        return address < 128 && (present[address >> 3] & (1 << (address & 7))) != 0;
+    }
+
+    /** Returns whether a new measurement for [slot] has been read, that wasn't yet returned by read(). */
+    bool hasResult(uint8_t slot) const {
+        return slot < count && devices[slot].fresh;
+    }
+
+    template <typename... types>
+    Streams::ReadResult read(uint8_t slot, types... args) {
+        if (!hasResult(slot)) {
+            return Streams::ReadResult::type::Invalid;
+        }
+        devices[slot].fresh = false;
+        return devices[slot].result.read(args...);
+    }
+
+    void loop() {
+        if (scanAddress != 0) {
+            scanStep();
+        }
+        finishReads();
+        const uint32_t now = rt->counts();
+        if (isAnyDue(now)) {
+            startConversions(now);
+            readConversions(now);
+        }
+    }
+
+    TaskState getTaskState() const {
+        if (scanAddress != 0 || twi->isTransceiving()) {
+            return TaskState::busy(SleepMode::IDLE);
+        }
+        Option<uint32_t> left = none();
+        const uint32_t now = rt->counts();
+        for (uint8_t i = 0; i < count; i++) {
+            const Device &d = devices[i];
+            if (d.state == State::READING) {
+                return TaskState::busy(SleepMode::IDLE);
+            }
+            const uint32_t l = isDue(d, now) ? 0 : d.due - now;
+            if (left.isEmpty() || l < left.get()) {
+                left = l;
+            }
+        }
+        if (left.isEmpty()) {
+            return TaskState::idle();
+        }
+        return TaskState(some(toMillisOn<rt_t>(Counts(left.get()))), SleepMode::POWER_DOWN);
+    }
+};
+
+}
+
+template <uint8_t maxDevices = 12, typename twi_t, typename rt_t, typename window_t = decltype(20_ms)>
+Impl::TWIScheduler<twi_t, rt_t, maxDevices> twiScheduler(twi_t &twi, rt_t &rt, window_t window = 20_ms) {
+    return { twi, rt, window };
+}
+
+}
+}
@@ -41,6 +41,14 @@ public:
         info::OCIE.clear();
     }
 
+    /**
+     * Clears a pending match, without enabling the interrupt. Hardware that triggers on the match flag,
+     * like the ADC auto trigger, only sees the next match once the flag has been cleared.
+     */
+    __attribute__((always_inline)) inline static void clearMatch() {
+        info::OCF.set();  // Datasheet: "OCF is cleared by writing logic 1 to the bit"
+    }
+
     static bool isOutputConnected() {
     	return info::COM0.isSet() || info::COM1.isSet();
     }
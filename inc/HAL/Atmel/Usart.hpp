@@ -45,6 +45,8 @@ template <typename info, uint8_t writeFifoCapacity>
 class UsartTx {
     typedef UsartTx<info, writeFifoCapacity> This;
     Fifo<writeFifoCapacity>  writeFifo = {};
+    volatile uint8_t *span = nullptr;
+    uint8_t spanLength = 0;
     uint8_t available = 0;
 
     static void startWriting() {
@@ -55,15 +57,45 @@ class UsartTx {
         }
     }
 
+    /**
+     * Writes straight into the fifo, making every byte visible to the interrupt right away. Only when the fifo
+     * is full, the interrupt is kicked and we wait, without toggling the interrupt flag while spinning.
+     */
+    struct BlockingSemantics: public Streams::Impl::BlockingWriteSemantics<AbstractFifo> {
+        static inline void write(AbstractFifo &fifo, uint8_t value) {
+            if (fifo.fastIsFull()) {
+                if (SREG_I.isCleared()) {
+                    return;
+                }
+                startWriting();
+                uint16_t counter = 65000;
+                while (fifo.fastIsFull() && ((counter--) > 0)) ;
+                if (fifo.fastIsFull()) {
+                    return;
+                }
+            }
+            fifo.uncheckedWrite(value);
+        }
+
+        static inline void start(AbstractFifo &fifo) {}
+
+        static inline void end(AbstractFifo &fifo, bool valid) {}
+    };
+
     __attribute__((always_inline)) inline void onSendComplete() {
         // clear the TXC bit -- "can be cleared by writing a one to its bit location"
     	info::TXC.set();
 
-        if (available > 0 || ((available = writeFifo._getSize()) > 0)) {
+        if (available == 0) {
+            // release the previous span in one go, and fetch the next one
+            writeFifo.fastSkip(spanLength);
+            available = spanLength = writeFifo.fastReadSpan(span);
+        }
+
+        if (available > 0) {
             // There is more data in the output buffer. Send the next byte
-            uint8_t next;
-            writeFifo._uncheckedRead(next);
-            info::UDR.val() = next;
+            info::UDR.val() = *span;
+            span++;
             available--;
         } else {
 			// Buffer empty, so disable interrupts
@@ -85,31 +117,24 @@ public:
 
     template <typename... types>
     bool writeOrBlock(types... args) {
-        writeFifo.template writeOrBlockWith<&This::startWriting>(args...);
-
-        AtomicScope _;
-        if (writeFifo.hasContent()) {
-            available = writeFifo.getSize();
-            startWriting();
-        }
-
+        Streams::Impl::write<BlockingSemantics>(writeFifo, args...);
+        startWriting();
         return true;
     }
 
     template <typename... types>
     bool writeIfSpace(types... args) {
         bool result = writeFifo.writeIfSpace(args...);
-
-        AtomicScope _;
-        if (writeFifo.hasContent()) {
+        if (result) {
             startWriting();
         }
-
         return result;
     }
 
     void clear() {
+        AtomicScope _;
         writeFifo.clear();
+        available = spanLength = 0;
     }
 
     void flush() {
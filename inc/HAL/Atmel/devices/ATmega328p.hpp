@@ -22,6 +22,8 @@ struct Power {
             SMCR.apply(~SM2 | SM1 | ~SM0); break;
         case SleepMode::STANDBY:
             SMCR.apply(SM2 | SM1 | ~SM0); break;
+        case SleepMode::ADC:
+            SMCR.apply(~SM2 | ~SM1 | SM0); break;
         case SleepMode::IDLE:
             SMCR.apply(~SM2 | ~SM1 | ~SM0); break;
         }
@@ -206,6 +208,8 @@ struct Timer0Info {
         static constexpr auto COM0 = COM0A0;
         static constexpr auto COM1 = COM0A1;
         static constexpr auto FOC = FOC0A;
+        /** ADC auto trigger source selecting this comparator's match */
+        static constexpr auto ADTS = ADTS0 | ADTS1 | ~ADTS2;
     };
     struct ComparatorB: public Comparator {
         typedef Int_TIMER0_COMPB_ INT;
@@ -278,6 +282,8 @@ struct Timer1Info {
         static constexpr auto COM0 = COM1B0;
         static constexpr auto COM1 = COM1B1;
         static constexpr auto FOC = FOC1B;
+        /** ADC auto trigger source selecting this comparator's match */
+        static constexpr auto ADTS = ADTS0 | ~ADTS1 | ADTS2;
     };
 };
 
@@ -766,8 +772,8 @@ struct TWIInfo {
     typedef Info::PinPC5Info PinSCL;
 };
 
-template <uint8_t txFifoSize = 32, uint8_t rxFifoSize = 32, uint32_t twiFreq = 100000l>
-using TWI = Impl::TWI<TWIInfo, txFifoSize, rxFifoSize, twiFreq>;
+template <uint8_t txFifoSize = 32, uint8_t rxFifoSize = 32, uint32_t twiFreq = 100000l, uint8_t queueSize = 8>
+using TWI = Impl::TWI<TWIInfo, txFifoSize, rxFifoSize, twiFreq, queueSize>;
 
 
 } // namespace Atmel
@@ -9,18 +9,28 @@ namespace HopeRF {
 
 using namespace Serial;
 
+/**
+ * Holds packets to be sent by the RFM12. Every chunk starts with a PacketType byte. FSK packets are stored as complete JeeLib frames, i.e. header, length,
+ * payload and CRC are all calculated when the packet is written. That way, read() only has to generate the
+ * preamble and sync bytes, and can otherwise send bytes straight from the fifo.
+ */
 template <typename callback_t, typename target_t, int groupId = 5, int fifoSize = 32>
 class JeeLibTxFifo {
 public:
+    enum PacketType: uint8_t {
+        FSK, OOK
+    };
+
     enum PacketIndex {
-        PREAMBLE1, PREAMBLE2, PREAMBLE3, SYNC1, SYNC2, HEADER, LENGTH, DATA, CRCLSB, CRCMSB, POSTFIX, DONE
+        PREAMBLE, SYNC1, SYNC2, FRAME, POSTFIX, DONE
     };
 
     Fifo<fifoSize> data;
     ChunkedFifoCB<callback_t, target_t> fifo;
-    CRC16 crc;
 
-    PacketIndex packetIndex = PacketIndex::PREAMBLE1;
+    PacketIndex packetIndex = PacketIndex::PREAMBLE;
+    uint16_t preambleLength = 3;
+    uint16_t preambleLeft = 0;
 
 public:
     JeeLibTxFifo(target_t &target): fifo(data, target) {}
@@ -29,28 +39,65 @@ public:
         return fifo;
     }
 
+    /**
+     * Sets the number of 0xAA preamble bytes sent in front of each FSK packet. Receivers that only
+     * listen periodically need a preamble that's at least as long as their sleep period.
+     */
+    void setPreambleLength(uint16_t length) {
+        preambleLength = (length > 0) ? length : 1;
+    }
+
+    uint16_t getPreambleLength() const {
+        return preambleLength;
+    }
+
     template <typename T>
-    bool write_ook(SerialConfig *type, T *packet) {
-        auto type_ptr = (uintptr_t) type;
-        return fifo.write(type_ptr, packet);
+    bool write_ook(T *packet) {
+        return fifo.write(uint8_t(OOK), packet);
     }
 
     template <typename... types>
     bool write_fsk(uint8_t header, types...args) {
-        return fifo.write(uintptr_t(0), header, args...);
+        volatile uint8_t *length;
+        fifo.writeStart();
+        if (!fifo.write(uint8_t(FSK), header) || !fifo.reserve(length)) {
+            fifo.writeAbort();
+            return false;
+        }
+        const uint8_t before = fifo.getSpace();
+        if (!fifo.write(args...)) {
+            fifo.writeAbort();
+            return false;
+        }
+        const uint8_t n = before - fifo.getSpace();
+
+        CRC16 crc;
+        crc.append(groupId);
+        crc.append(header);
+        crc.append(n);
+        fifo.forEachWrittenAfter(length, [&crc] (uint8_t b) { crc.append(b); });
+        if (!fifo.write(uint8_t(crc.get()), uint8_t(crc.get() >> 8))) {
+            fifo.writeAbort();
+            return false;
+        }
+        *length = n;
+        fifo.writeEnd();
+        return true;
     }
 
-    /** Returns whether or not this indeed is an FSK packet, i.e. SerialConfig was nullptr calling out(). */
+    /**
+     * Returns whether or not this indeed is an FSK packet. For OOK packets, the fifo is left reading
+     * just after the type byte, for the OOK pulse source to continue with.
+     */
     bool readStart() {
         fifo.readStart();
-        SerialConfig *type;
-        if (fifo.read((uintptr_t*) (&type))) {
-            if (type == nullptr) {
-                crc.reset();
-                packetIndex = PacketIndex::PREAMBLE1;
+        uint8_t type;
+        if (fifo.read(&type)) {
+            if (type == FSK) {
+                preambleLeft = preambleLength;
+                packetIndex = PacketIndex::PREAMBLE;
                 return true;
             } else {
-                fifo.readAbort();
                 return false;
             }
         } else {
@@ -64,38 +111,18 @@ public:
 
     void read(uint8_t &b) {
         switch(packetIndex) {
-            case PREAMBLE1:
-                b = 0xAA; packetIndex = PREAMBLE2; break;
-            case PREAMBLE2:
-                b = 0xAA; packetIndex = PREAMBLE3; break;
-            case PREAMBLE3:
-                b = 0xAA; packetIndex = SYNC1; break;
+            case PREAMBLE:
+                b = 0xAA;
+                if (--preambleLeft == 0) packetIndex = SYNC1;
+                break;
             case SYNC1:
                 b = 0x2D; packetIndex = SYNC2; break;
             case SYNC2:
-                b = groupId;
-                crc.append(b);
-                packetIndex = HEADER;
-                break;
-            case HEADER:
-                fifo.read(&b);
-                crc.append(b);
-                packetIndex = LENGTH;
-                break;
-            case LENGTH:
-                b = fifo.getReadAvailable();
-                crc.append(b);
-                packetIndex = (b > 0) ? DATA : CRCLSB;
-                break;
-            case DATA:
-                fifo.read(&b);
-                crc.append(b);
-                if (fifo.getReadAvailable() == 0) packetIndex = CRCLSB;
+                b = groupId; packetIndex = FRAME; break;
+            case FRAME:
+                fifo.uncheckedRead(b);
+                if (!fifo.hasReadAvailable()) packetIndex = POSTFIX;
                 break;
-            case CRCLSB:
-                b = (uint8_t)(crc.get()); packetIndex = CRCMSB; break;
-            case CRCMSB:
-                b = (uint8_t)(crc.get() >> 8); packetIndex = POSTFIX; break;
             case POSTFIX:
                 b = 0xAA; packetIndex = DONE; break;
             case DONE:
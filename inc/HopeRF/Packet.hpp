@@ -27,7 +27,7 @@ struct Packet {
     > DefaultProtocol;
 };
 
-template <typename T, typename in_t>
+template <typename T, uint8_t header = Headers::RXSTATE, typename in_t>
 Option<Packet<T>> readPacket(in_t in, const uint16_t nodeId) {
   typedef Logging::Log<Loggers::RxState> log;
 
@@ -36,7 +36,7 @@ Option<Packet<T>> readPacket(in_t in, const uint16_t nodeId) {
     }
     in.readStart();
     Packet<T> packet;
-    if (in.read(FB(Headers::RXSTATE), &packet)) {
+    if (in.read(FB(header), &packet)) {
         if (packet.nodeId == nodeId) {
             in.readEnd();
             return packet;
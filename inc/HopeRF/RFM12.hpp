@@ -41,9 +41,33 @@ struct Headers {
     static constexpr uint8_t RXSTATE = 2; // State from spark to node
     static constexpr uint8_t TXSTATE = 3; // State from node to spark
     static constexpr uint8_t REQ = 4;     // Request re-send of latest state
+    static constexpr uint8_t TXWINDOW = 6;      // Windowed packet from node to spark
+    static constexpr uint8_t RXWINDOW = 7;      // Windowed packet from spark to node
+    static constexpr uint8_t TX_WINDOW_ACK = 8; // Ack from node for RXWINDOW packets
+    static constexpr uint8_t RX_WINDOW_ACK = 9; // Ack to node for TXWINDOW packets
+    static constexpr uint8_t TOPOLOGY = 10;     // Neighbours and routes announced by a Router
+    static constexpr uint8_t ROUTED = 11;       // Packet forwarded by Routers towards a target node
     static constexpr uint8_t APP = 42;
 };
 
+namespace Impl {
+
+/**
+ * Returns the RF_WAKEUP_TIMER command for a wake-up period of [millis]. The RFM12 implements the
+ * period as 1.03 * M * 2^R ms, with M being 8 bits, so we pick the lowest R that fits M.
+ */
+constexpr uint16_t wakeupTimerCommand(uint32_t millis) {
+    uint32_t m = millis * 100 / 103;
+    uint8_t r = 0;
+    while (m > 255) {
+        m >>= 1;
+        r++;
+    }
+    return 0xE000 | (uint16_t(r) << 8) | ((m > 0) ? m : 1);
+}
+
+}
+
 template <typename spi_t,
           typename ss_pin_t,
           typename int_pin_t,
@@ -75,6 +99,13 @@ private:
     int_pin_t * const int_pin;
     comparator_t * const comparator;
     bool listenOnIdle = true;
+    /** RF_WAKEUP_TIMER commands for the sleep period and listen window, or 0 when listening continuously. */
+    uint16_t listenPeriodCmd = 0;
+    uint16_t listenWindowCmd = 0;
+
+    bool isDutyCycled() const {
+        return listenPeriodCmd != 0;
+    }
 
     void command(uint16_t cmd) {
         ss_pin->setLow();
@@ -137,9 +168,7 @@ private:
                 if (listenOnIdle) {
                     log::debug(F("sendOrListen(): listen"));
                     log::flush();
-                    mode = Mode::LISTENING;
-                    int_pin->interruptOnLow();
-                    command(0x82DD); // RF_RECEIVER_ON
+                    listen();
                 } else {
                     log::debug(F("sendOrListen(): standby"));
                     mode = Mode::SLEEP;
@@ -150,6 +179,38 @@ private:
         }
     }
 
+    void listen() {
+        mode = Mode::LISTENING;
+        int_pin->interruptOnLow();
+        if (isDutyCycled()) {
+            command(listenWindowCmd);
+            command(0x82DF); // RF_RECEIVER_ON with wake-up timer
+        } else {
+            command(0x82DD); // RF_RECEIVER_ON
+        }
+    }
+
+    void sleepUntilWakeup() {
+        mode = Mode::SLEEP;
+        command(listenPeriodCmd);
+        command(0x8207); // RF_SLEEP_MODE with wake-up timer
+    }
+
+    void onWakeup(BitSet<RFM12Status> status) {
+        if (mode == Mode::SLEEP) {
+            listen();
+        } else if (mode == Mode::LISTENING) {
+            if (status[RFM12Status::DATA_QUALITY]) {
+                // A preamble is on the air, so extend the window until its sync word comes in.
+                command(0x82DD); // RF_RECEIVER_ON, stopping the wake-up timer so it can be re-armed
+                listen();
+            } else {
+                sleepUntilWakeup();
+            }
+        }
+        // When receiving or sending, sendOrListen() will open a new listen window afterwards.
+    }
+
     void onInterrupt() {
         ints++;
         uint8_t in = 0;
@@ -189,6 +250,10 @@ private:
             }
         }
 
+        if (status[RFM12Status::WAKEUP] && isDutyCycled()) {
+            onWakeup(status);
+        }
+
         // power-on reset
         if (status[RFM12Status::POWER_ON_RESET]) {
             idle();
@@ -291,14 +356,15 @@ private:
     };
 
     friend struct OOKSource;
-    struct OOKSource: public ChunkPulseSource {
+    struct OOKSource: public ChunkPulseSource<FS20::FS20Packet::serialConfig<comparator_t>> {
+        typedef ChunkPulseSource<FS20::FS20Packet::serialConfig<comparator_t>> Super;
         This *rfm12;
 
-        OOKSource(This *_rfm12, AbstractChunkedFifo &_fifo): ChunkPulseSource(_fifo), rfm12(_rfm12) {}
+        OOKSource(This *_rfm12, AbstractChunkedFifo &_fifo): Super(_fifo), rfm12(_rfm12) {}
 
         Pulse getNextPulse() {
             rfm12->pulses++;
-            Pulse result = ChunkPulseSource::getNextPulse();
+            Pulse result = Super::getNextPulse();
             if (!result.isEmpty()) {
                 // because of SPI delays, and the DELAY and TRANSMITTER_ON messages being processed by the RFM12
                 // at different delays, we need to make an adjustment between the desired pulse lengths, and the actual
@@ -318,7 +384,6 @@ private:
     OOKSource ookSource = { this, txFifo.getChunkedFifo() };
     typedef PulseTx<comparator_t, OOKTarget, OOKSource> ookTx_t;
     ookTx_t ookTx = ookTx_t(*comparator, ookTarget, ookSource);
-    SerialConfig fs20SerialConfig = FS20::FS20Packet::serialConfig<comparator_t>();
 
 public:
     typedef
@@ -361,8 +426,39 @@ public:
     void onIdleListen() {
         AtomicScope _;
 
+        const bool wasDutyCycled = isDutyCycled();
         listenOnIdle = true;
-        if (mode == Mode::SLEEP) {
+        listenPeriodCmd = 0;
+        if (mode == Mode::LISTENING && wasDutyCycled) {
+            idle();
+        }
+        if (mode == Mode::SLEEP || mode == Mode::IDLE) {
+            sendOrListen();
+        }
+    }
+
+    /**
+     * Lets the RFM module listen periodically when idle, sleeping in between on the RFM12's own wake-up timer.
+     * Every [period], the receiver is turned on for [window]. The window is extended while a preamble is being
+     * received, and is re-opened after every received or sent packet. Senders should use stretchPreamble()
+     * with at least [period] + [window], so their packets can't fall entirely into our sleep period.
+     */
+    template <typename period_t, typename window_t>
+    void onIdleListenPeriodically(period_t period, window_t window) {
+        constexpr uint32_t periodMs = period_t::toMillis().getAmount();
+        constexpr uint32_t windowMs = window_t::toMillis().getAmount();
+        static_assert(periodMs > 0, "Sleep period must be at least 1ms");
+        static_assert(windowMs > 0, "Listen window must be at least 1ms");
+
+        AtomicScope _;
+
+        listenOnIdle = true;
+        listenPeriodCmd = Impl::wakeupTimerCommand(periodMs);
+        listenWindowCmd = Impl::wakeupTimerCommand(windowMs);
+        if (mode == Mode::LISTENING || mode == Mode::SLEEP) {
+            idle();
+        }
+        if (mode == Mode::IDLE) {
             sendOrListen();
         }
     }
@@ -373,8 +469,13 @@ public:
     void onIdleSleep() {
         AtomicScope _;
 
+        const bool wasDutyCycled = isDutyCycled();
         listenOnIdle = false;
-        if (mode == Mode::IDLE || mode == Mode::LISTENING) {
+        listenPeriodCmd = 0;
+        if (mode == Mode::LISTENING || (mode == Mode::SLEEP && wasDutyCycled)) {
+            idle();
+        }
+        if (mode == Mode::IDLE) {
             sendOrListen();
         }
     }
@@ -402,16 +503,30 @@ public:
     TaskState getTaskState() const {
     	AtomicScope _;
     	if (isIdle()) {
-    	    if (listenOnIdle) {
+    	    if (listenOnIdle && mode != Mode::SLEEP) {
     	        return TaskState::busy(SleepMode::STANDBY); // need quick resume in int handler
     	    } else {
     	        return TaskState::idle();
     	    }
     	} else {
-    		return TaskState::busy(160_us * txFifo.getSize(), SleepMode::IDLE);
+    		return TaskState::busy(160_us * (txFifo.getSize() + txFifo.getPreambleLength()), SleepMode::IDLE);
     	}
     }
 
+    /**
+     * Stretches the preamble of outgoing FSK packets to last at least [duration], so they're picked up by
+     * receivers that only listen periodically (see onIdleListenPeriodically()).
+     */
+    template <typename duration_t>
+    void stretchPreamble(duration_t duration) {
+        // One byte takes about 162.6us at 49.2kbps
+        constexpr uint32_t bytes = duration_t::toMicros().getAmount() / 162 + 1;
+        static_assert(bytes <= 0xFFFF, "Preamble duration is too long");
+
+        AtomicScope _;
+        txFifo.setPreambleLength((bytes > 3) ? bytes : 3);
+    }
+
     template <typename... types>
     bool write_fsk(uint8_t header, types... args) {
         return txFifo.write_fsk(header, args...);
@@ -419,7 +534,7 @@ public:
 
     bool write_fs20(const FS20::FS20Packet &packet) {
         log::debug(F("queueing FS20"));
-        return txFifo.write_ook(&fs20SerialConfig, &packet);
+        return txFifo.write_ook(&packet);
     }
 };
 
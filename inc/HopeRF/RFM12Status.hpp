@@ -9,7 +9,9 @@ enum class RFM12Status: uint16_t {
     READY_FOR_NEXT_BYTE = uint16_t(1) << 15,  // RGIT (when sending) or FFIT (when receiving)
     POWER_ON_RESET      = uint16_t(1) << 14,  // POR
     UNDERRUN_OVERFLOW   = uint16_t(1) << 13,  // RGUR (when sending) or FFOv (when receiving)
-    RSSI_OVER_THRESHOLD = uint16_t(1) << 8    // ATG (when sending) or RSSI (when receiving)
+    WAKEUP              = uint16_t(1) << 12,  // WKUP
+    RSSI_OVER_THRESHOLD = uint16_t(1) << 8,   // ATG (when sending) or RSSI (when receiving)
+    DATA_QUALITY        = uint16_t(1) << 7    // DQD, a valid preamble is being received
 };
 
 }
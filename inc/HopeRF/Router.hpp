@@ -0,0 +1,338 @@
+#pragma once
+
+#include "Time/RealTimer.hpp"
+#include "Time/UnitLiterals.hpp"
+#include "Streams/Nested.hpp"
+#include "ChunkedFifo.hpp"
+#include "Fifo.hpp"
+#include "RFM12.hpp"
+#include "Logging.hpp"
+
+namespace HopeRF {
+
+using namespace Time;
+using namespace Streams;
+
+/**
+ * One entry in a Router's table: the next hop to use in order to reach [target].
+ */
+struct Route {
+    uint16_t target;
+    uint16_t via;
+    /** Weakest link strength along the path, in dBm (as RFM12Strength reports it) */
+    int8_t strength;
+    /** Number of hops to [target], or 0 if this entry is unused */
+    uint8_t hops;
+    /** Number of announce periods since this route was last confirmed */
+    uint8_t age;
+
+    constexpr bool isUsed() const {
+        return hops != 0;
+    }
+
+    /** Returns whether a path of [h] hops with weakest link [s] is preferable over this route */
+    constexpr bool isWorseThan(uint8_t h, int8_t s) const {
+        return h < hops || (h == hops && s > strength);
+    }
+};
+
+/**
+ * Multi-hop routing on top of an RFM12, as described in rfm12-routing.txt.
+ *
+ * Every router periodically announces a TOPOLOGY packet with its own ID and the routes in its table. Routers that
+ * overhear it learn a direct route to the announcing node, and routes one hop longer to everything it can reach.
+ * Only the shortest (then strongest) path to each node is kept, in a table of [tableSize] entries, evicting
+ * the oldest and longest routes first.
+ *
+ * Packets written through write() are sent as ROUTED packets via the best known next hop. If there's no route
+ * to the target, the packet is flooded instead. Every router remembers the last [seenSize] (source, seq) pairs,
+ * so flooded packets are forwarded at most once per router. Forwards are delayed by a small random amount,
+ * to lower the chance of neighbours forwarding the same flood at the same time.
+ *
+ * Packets for this node are available on in(), prefixed with the 16-bit source node ID.
+ */
+template <typename rfm_t, typename rt_t, uint8_t tableSize = 8, int fifoSize = 64, uint8_t seenSize = 8>
+class Router {
+    typedef Logging::Log<Loggers::RFM12> log;
+
+public:
+    static constexpr uint16_t BROADCAST = 0xFFFF;
+    static constexpr uint8_t MAX_HOPS = 8;
+    static constexpr uint8_t MAX_AGE = 5;
+    /** Link strength to assume for neighbours that don't (yet) report how well they hear us */
+    static constexpr int8_t UNKNOWN_STRENGTH = -106;
+
+private:
+    struct Seen {
+        uint16_t source;
+        uint8_t seq;
+    };
+
+    rfm_t * const rfm;
+    rt_t * const rt;
+    const uint16_t nodeId;
+
+    Route routes[tableSize] = {};
+    Seen seen[seenSize] = {};
+    uint8_t seenNext = 0;
+    uint8_t seq = 0;
+    uint16_t random;
+
+    Fifo<fifoSize> inData = {};
+    ChunkedFifo inFifo = inData;
+    Fifo<fifoSize> forwardData = {};
+    ChunkedFifo forwardFifo = forwardData;
+
+    VariableDeadline<rt_t> announce = { *rt };
+    VariableDeadline<rt_t> forward = { *rt };
+
+    uint16_t nextRandom() {
+        // xorshift16
+        random ^= random << 7;
+        random ^= random >> 9;
+        random ^= random << 8;
+        return random;
+    }
+
+    bool isSeen(uint16_t source, uint8_t s) const {
+        for (uint8_t i = 0; i < seenSize; i++) {
+            if (seen[i].source == source && seen[i].seq == s) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void markSeen(uint16_t source, uint8_t s) {
+        seen[seenNext] = { source, s };
+        seenNext = (seenNext + 1) % seenSize;
+    }
+
+    Route *find(uint16_t target) {
+        for (uint8_t i = 0; i < tableSize; i++) {
+            if (routes[i].isUsed() && routes[i].target == target) {
+                return routes + i;
+            }
+        }
+        return nullptr;
+    }
+
+    Route *victim() {
+        Route *result = routes;
+        for (uint8_t i = 0; i < tableSize; i++) {
+            Route *r = routes + i;
+            if (!r->isUsed()) {
+                return r;
+            }
+            if (r->age > result->age || (r->age == result->age && r->hops > result->hops)) {
+                result = r;
+            }
+        }
+        return result;
+    }
+
+    void update(uint16_t target, uint16_t via, uint8_t hops, int8_t strength) {
+        if (target == nodeId || target == BROADCAST || hops > MAX_HOPS) {
+            return;
+        }
+        Route *r = find(target);
+        if (r != nullptr) {
+            if (r->via != via && !r->isWorseThan(hops, strength)) {
+                return;
+            }
+        } else {
+            r = victim();
+            if (r->isUsed() && r->age == 0 && !r->isWorseThan(hops, strength)) {
+                return;
+            }
+        }
+        *r = { target, via, strength, hops, 0 };
+    }
+
+    void onTopology(uint16_t from, const Route *received, uint8_t count) {
+        int8_t link = UNKNOWN_STRENGTH;
+        for (uint8_t i = 0; i < count; i++) {
+            if (received[i].target == nodeId && received[i].hops == 1) {
+                link = received[i].strength;
+            }
+        }
+        update(from, from, 1, link);
+        for (uint8_t i = 0; i < count; i++) {
+            const int8_t s = (received[i].strength < link) ? received[i].strength : link;
+            update(received[i].target, from, received[i].hops + 1, s);
+        }
+    }
+
+    bool readTopology() {
+        auto in = rfm->in();
+        uint16_t from;
+        uint8_t count;
+        Route received[tableSize];
+        uint8_t stored = 0;
+
+        in.readStart();
+        if (in.read(FB(Headers::TOPOLOGY), &from, &count, Nested([&] (auto read) -> ReadResult {
+            for (uint8_t i = 0; i < count; i++) {
+                Route r = {};
+                const ReadResult result = read(&r.target, &r.strength, &r.hops);
+                if (result != ReadResult::Valid) {
+                    return result;
+                }
+                if (stored < tableSize) {
+                    received[stored] = r;
+                    stored++;
+                }
+            }
+            return ReadResult::Valid;
+        }))) {
+            in.readEnd();
+            onTopology(from, received, stored);
+            return true;
+        }
+        in.readAbort();
+        return false;
+    }
+
+    bool readRouted() {
+        auto in = rfm->in();
+        uint16_t target, source, via;
+        uint8_t s, hops;
+
+        in.readStart();
+        if (!in.read(FB(Headers::ROUTED), &target, &source, &via, &s, &hops)) {
+            in.readAbort();
+            return false;
+        }
+
+        if (source != nodeId && !isSeen(source, s) && (via == nodeId || via == BROADCAST)) {
+            markSeen(source, s);
+            if (target == nodeId) {
+                log::debug(F("routed from "), dec(source));
+                inFifo.write(source, in);
+            } else if (hops < MAX_HOPS) {
+                Route *r = find(target);
+                const uint16_t next = (r != nullptr) ? r->via : BROADCAST;
+                if (forwardFifo.write(target, source, next, s, uint8_t(hops + 1), in) && forward.isElapsed()) {
+                    forward.schedule(Milliseconds(4 * (1 + (nextRandom() & 0x0F))));
+                }
+            }
+        }
+        in.readEnd();
+        return true;
+    }
+
+    void sendTopology() {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < tableSize; i++) {
+            if (routes[i].isUsed() && routes[i].hops < MAX_HOPS) {
+                count++;
+            }
+        }
+        rfm->write_fsk(Headers::TOPOLOGY, nodeId, count, Nested([&] (auto write) -> bool {
+            for (uint8_t i = 0; i < tableSize; i++) {
+                const Route &r = routes[i];
+                if (r.isUsed() && r.hops < MAX_HOPS) {
+                    if (!write(r.target, r.strength, r.hops)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }));
+    }
+
+    void ageRoutes() {
+        for (uint8_t i = 0; i < tableSize; i++) {
+            if (routes[i].isUsed()) {
+                routes[i].age++;
+                if (routes[i].age > MAX_AGE) {
+                    log::debug(F("route expired "), dec(routes[i].target));
+                    routes[i].hops = 0;
+                }
+            }
+        }
+    }
+
+    void scheduleAnnounce() {
+        announce.schedule(Milliseconds(60000 + (nextRandom() & 0x0FFF)));
+    }
+
+public:
+    Router(rfm_t &_rfm, rt_t &_rt, uint16_t _nodeId):
+        rfm(&_rfm), rt(&_rt), nodeId(_nodeId), random(_nodeId | 1) {
+        scheduleAnnounce();
+    }
+
+    /**
+     * Returns the packets that have been routed to this node. Each chunk starts with the source node ID (uint16_t),
+     * followed by the payload as given to write() on the source node.
+     */
+    ChunkedFifo::In in() {
+        return inFifo.in();
+    }
+
+    /**
+     * Sends the given payload towards [target], via the best known next hop, or as flood if no route is known.
+     */
+    template <typename... types>
+    bool write(uint16_t target, types... args) {
+        Route *r = find(target);
+        const uint16_t via = (r != nullptr) ? r->via : BROADCAST;
+        markSeen(nodeId, seq);
+        return rfm->write_fsk(Headers::ROUTED, target, nodeId, via, seq++, uint8_t(0), args...);
+    }
+
+    /** Returns the current route to [target], if any. */
+    Option<Route> getRoute(uint16_t target) {
+        Route *r = find(target);
+        if (r != nullptr) {
+            return *r;
+        } else {
+            return none();
+        }
+    }
+
+    /** Announces our routing table right away, rather than waiting for the next period. */
+    void announceNow() {
+        sendTopology();
+        scheduleAnnounce();
+    }
+
+    void loop() {
+        if (rfm->in().hasContent()) {
+            if (!readTopology()) {
+                readRouted();
+            }
+        }
+
+        if (forward.isNow()) {
+            while (forwardFifo.hasContent()) {
+                forwardFifo.readStart();
+                if (rfm->write_fsk(Headers::ROUTED, forwardFifo.in())) {
+                    forwardFifo.readEnd();
+                } else {
+                    forwardFifo.readAbort();
+                    forward.schedule(Milliseconds(4 * (1 + (nextRandom() & 0x0F))));
+                    break;
+                }
+            }
+        }
+
+        if (announce.isNow()) {
+            ageRoutes();
+            announceNow();
+        }
+    }
+
+    TaskState getTaskState() {
+        const Milliseconds announceLeft = announce.timeLeft().template toMillisOn<rt_t>();
+        if (forward.isScheduled()) {
+            const Milliseconds forwardLeft = forward.timeLeft().template toMillisOn<rt_t>();
+            return TaskState((forwardLeft < announceLeft) ? forwardLeft : announceLeft, SleepMode::POWER_DOWN);
+        } else {
+            return TaskState(announceLeft, SleepMode::POWER_DOWN);
+        }
+    }
+};
+
+}
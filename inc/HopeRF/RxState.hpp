@@ -35,7 +35,6 @@ public:
       log::debug(F("got seq "), dec(packet.seq));
       const Ack ack = { packet.seq, nodeId };
       rfm->write_fsk(Headers::TX_ACK, &ack);
-      rfm->write_fsk(Headers::TX_ACK, &ack);
 
       if (cleared || packet.body != state) {
         cleared = false;
@@ -117,7 +117,6 @@ public:
 
                 const Ack ack = { packet.seq, nodeId };
                 rfm->write_fsk(Headers::TX_ACK, &ack);
-                rfm->write_fsk(Headers::TX_ACK, &ack);
 
                 seq = packet.seq;
                 if (packet.body != state) {
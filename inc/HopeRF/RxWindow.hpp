@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Streams/Protobuf.hpp"
+#include "Option.hpp"
+#include "WindowAck.hpp"
+#include "Packet.hpp"
+#include "RFM12.hpp"
+#include "Logging.hpp"
+
+namespace HopeRF {
+
+using namespace Streams;
+
+/**
+ * Receives packets sent through a TxWindow on the other end, buffering up to [windowSize] packets that arrive out of
+ * order, and delivering them to the app in sequence. Every incoming packet is answered with exactly one WindowAck,
+ * which describes everything received so far.
+ */
+template <typename rfm_t, typename T, uint8_t windowSize = 4>
+class RxWindow {
+    static_assert(windowSize > 0 && windowSize <= 8, "Received packets must fit in an 8-bit mask");
+    typedef Logging::Log<Loggers::RxState> log;
+
+    rfm_t * const rfm;
+    const uint16_t nodeId;
+
+    T slots[windowSize];
+    uint8_t first = 0;       // Index into slots for the [expected] packet
+    uint8_t received = 0;    // Bit n is set if packet expected + n has been received
+    uint8_t expected = 0;    // Sequence number of the next packet to deliver
+    bool synchronized = false;
+
+    void sendAck() {
+        uint8_t seq = expected - 1;
+        uint8_t bits = received;
+        while (bits & 1) {
+            seq++;
+            bits >>= 1;
+        }
+        const WindowAck ack = { nodeId, seq, uint8_t(bits >> 1) };
+        rfm->write_fsk(Headers::TX_WINDOW_ACK, &ack);
+    }
+
+    void onPacket(const Packet<T> &packet) {
+        uint8_t d = packet.seq - expected;
+        const uint8_t behind = expected - packet.seq;
+        if (!synchronized || (d >= windowSize && behind > windowSize)) {
+            // Sender can't legitimately be this far off, so it must have restarted.
+            log::debug(F("sync "), dec(packet.seq));
+            expected = packet.seq;
+            received = 0;
+            d = 0;
+            synchronized = true;
+        }
+        if (d < windowSize) {
+            slots[(first + d) % windowSize] = packet.body;
+            received |= (1 << d);
+        }
+        sendAck();
+    }
+
+public:
+    RxWindow(rfm_t &_rfm, uint16_t _nodeId): rfm(&_rfm), nodeId(_nodeId) {}
+
+    /**
+     * Handles any incoming packet, and returns the next packet in sequence, if it has been received.
+     */
+    Option<T> read() {
+        for (auto packet: readPacket<T, Headers::RXWINDOW>(rfm->in(), nodeId)) {
+            onPacket(packet);
+        }
+        if (received & 1) {
+            const T result = slots[first];
+            first = (first + 1) % windowSize;
+            received >>= 1;
+            expected++;
+            return result;
+        } else {
+            return none();
+        }
+    }
+};
+
+}
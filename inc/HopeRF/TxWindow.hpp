@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Time/RealTimer.hpp"
+#include "Time/UnitLiterals.hpp"
+#include "WindowAck.hpp"
+#include "Packet.hpp"
+#include "RFM12.hpp"
+#include "Logging.hpp"
+
+namespace HopeRF {
+
+using namespace Time;
+
+/**
+ * Reliably sends a sequence of packets of type T, keeping up to [windowSize] of them in flight at the same time,
+ * instead of waiting for an ack after every packet like TxState does.
+ *
+ * The receiving side (see RxWindow) answers every packet with a single WindowAck, which acknowledges packets both
+ * cumulatively and selectively, so on a timeout only the packets that actually went missing are resent.
+ * The resend timeout adapts to the round trip time measured on packets that were acked without being resent.
+ */
+template <typename rfm_t, typename rt_t, typename T, uint8_t windowSize = 4>
+class TxWindow {
+    static_assert(windowSize > 0 && windowSize <= 9, "A WindowAck can cover at most 9 packets");
+    typedef Logging::Log<Loggers::TxState> log;
+
+    static constexpr uint32_t initialTimeout = toCountsOn<rt_t>(150_ms).getValue();
+    static constexpr uint32_t minTimeout = toCountsOn<rt_t>(10_ms).getValue();
+    static constexpr uint32_t maxTimeout = toCountsOn<rt_t>(1560_ms).getValue();
+
+    struct Slot {
+        T body;
+        uint32_t sentAt;
+        bool acked;
+        bool resent;
+    };
+
+    rfm_t *const rfm;
+    rt_t *const rt;
+    const uint16_t nodeId;
+    const uint32_t resendOffset; // Fixed offset to add to resend delay, depending on nodeId, to combat interference from several nodes
+
+    Slot slots[windowSize];
+    uint8_t first = 0;     // Index into slots of the oldest packet in flight
+    uint8_t count = 0;     // Number of packets in flight
+    uint8_t firstSeq = 0;  // Sequence number of the oldest packet in flight
+
+    uint32_t srtt = 0;     // Smoothed round trip time, in counts, times 8
+    uint32_t rttvar = 0;   // Round trip time variation, in counts, times 4
+    uint32_t timeout = initialTimeout;
+    VariableDeadline<rt_t> resend = { *rt };
+
+    Slot &slot(uint8_t i) {
+        return slots[(first + i) % windowSize];
+    }
+
+    void transmit(uint8_t i) {
+        Slot &s = slot(i);
+        log::debug(F("send: seq="), dec(uint8_t(firstSeq + i)));
+        Packet<T> packet = { uint8_t(firstSeq + i), nodeId, s.body };
+        rfm->write_fsk(Headers::TXWINDOW, &packet);
+        s.sentAt = rt->counts();
+    }
+
+    void scheduleResend() {
+        resend.schedule(Counts(timeout + resendOffset));
+    }
+
+    void measure(uint32_t rtt) {
+        if (srtt == 0) {
+            srtt = rtt << 3;
+            rttvar = rtt << 1;
+        } else {
+            int32_t err = int32_t(rtt) - int32_t(srtt >> 3);
+            srtt += err;
+            if (err < 0) {
+                err = -err;
+            }
+            rttvar += err - int32_t(rttvar >> 2);
+        }
+        timeout = (srtt >> 3) + rttvar;
+        if (timeout < minTimeout) {
+            timeout = minTimeout;
+        } else if (timeout > maxTimeout) {
+            timeout = maxTimeout;
+        }
+    }
+
+    void onAck(const WindowAck &ack) {
+        const uint32_t now = rt->counts();
+        for (uint8_t i = 0; i < count; i++) {
+            Slot &s = slot(i);
+            if (!s.acked && ack.covers(firstSeq + i)) {
+                s.acked = true;
+                if (!s.resent) {
+                    measure(now - s.sentAt);
+                }
+            }
+        }
+
+        const uint8_t before = count;
+        while (count > 0 && slot(0).acked) {
+            first = (first + 1) % windowSize;
+            firstSeq++;
+            count--;
+        }
+
+        if (count == 0) {
+            log::debug(F("ack."));
+            resend.cancel();
+        } else if (count < before) {
+            scheduleResend();
+        }
+    }
+
+public:
+    TxWindow(rfm_t &r, rt_t &t, uint16_t _nodeId):
+        rfm(&r), rt(&t), nodeId(_nodeId),
+        resendOffset(uint32_t(toCountsOn<rt_t>(4_ms).getValue()) * (((_nodeId) ^ (_nodeId >> 4) ^ (_nodeId >> 8) ^ (_nodeId >> 12)) & 0x000F)) {}
+
+    /**
+     * Queues [t] to be sent reliably, and sends it immediately. Returns false if the window is full, i.e.
+     * [windowSize] packets are still waiting to be acked.
+     */
+    bool send(const T &t) {
+        if (count >= windowSize) {
+            return false;
+        }
+        Slot &s = slot(count);
+        s.body = t;
+        s.acked = false;
+        s.resent = false;
+        count++;
+        transmit(count - 1);
+        if (count == 1) {
+            scheduleResend();
+        }
+        return true;
+    }
+
+    /** Returns the number of packets that are still waiting to be acked */
+    uint8_t getInFlight() const {
+        return count;
+    }
+
+    bool isFull() const {
+        return count >= windowSize;
+    }
+
+    /** Returns the current resend timeout, as derived from the measured round trip time */
+    Counts getTimeout() const {
+        return timeout;
+    }
+
+    void loop() {
+        for (auto ack: readWindowAck(rfm->in(), nodeId)) {
+            onAck(ack);
+        }
+        if (count > 0 && resend.isNow()) {
+            log::debug(F("resend"));
+            for (uint8_t i = 0; i < count; i++) {
+                if (!slot(i).acked) {
+                    slot(i).resent = true;
+                    transmit(i);
+                }
+            }
+            timeout = (timeout < maxTimeout / 2) ? timeout * 2 : maxTimeout;
+            scheduleResend();
+        }
+    }
+
+    TaskState getTaskState() {
+        if (count == 0) {
+            return TaskState::idle();
+        } else {
+            return TaskState(resend.timeLeft().template toMillisOn<rt_t>(), SleepMode::IDLE);
+        }
+    }
+};
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Streams/Protobuf.hpp"
+#include "Option.hpp"
+#include "RFM12.hpp"
+
+namespace HopeRF {
+
+using namespace Streams;
+
+/**
+ * Acknowledges packets sent through a TxWindow. [seq] is cumulative, i.e. all packets up to and including [seq]
+ * have been received. In addition, bit n of [mask] is set if packet seq + 2 + n has been received out of order.
+ */
+struct WindowAck {
+    uint16_t nodeId;
+    uint8_t seq;
+    uint8_t mask;
+
+    constexpr bool operator!=(const WindowAck &that) const {
+        return nodeId != that.nodeId || seq != that.seq || mask != that.mask;
+    }
+
+    typedef Protobuf::Protocol<WindowAck> P;
+
+    typedef P::Message<
+        P::Varint<1, uint16_t, &WindowAck::nodeId>,
+        P::Varint<2, uint8_t, &WindowAck::seq>,
+        P::Varint<3, uint8_t, &WindowAck::mask>
+    > DefaultProtocol;
+
+    /** Returns whether this ack covers the packet with the given sequence number */
+    constexpr bool covers(uint8_t s) const {
+        return uint8_t(seq - s) < 128 || (uint8_t(s - seq - 2) < 8 && (mask & (1 << uint8_t(s - seq - 2))));
+    }
+};
+
+template <typename in_t>
+Option<WindowAck> readWindowAck(in_t in, const uint16_t nodeId) {
+    if (!in.hasContent()) {
+        return none();
+    }
+
+    WindowAck ack;
+    ack.mask = 0;
+    in.readStart();
+    if (in.read(FB(Headers::RX_WINDOW_ACK), &ack)) {
+        if (ack.nodeId == nodeId) {
+            in.readEnd();
+            return ack;
+        }
+    }
+    in.readAbort();
+    return none();
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#ifdef AVR
+#error HostLogSink is the logging backend of host builds, devices log through onMessage()
+#endif
+
+#include <stdint.h>
+
+namespace Logging {
+namespace Impl {
+
+/**
+ * One log line as it's being formatted by a single thread. It has just enough of the fifo interface for
+ * Streams::Impl::writeIfSpace(), but no AtomicScope, since each thread has its own.
+ */
+class LineBuffer {
+public:
+    /** Space for the prefix, up to 250 characters of message, and the line end. */
+    static constexpr uint16_t capacity = 280;
+
+private:
+    static constexpr uint8_t maxMessage = 250;
+
+    char text[capacity];
+    uint16_t length = 0;
+    uint16_t messageStart = 0;
+    uint16_t mark = 0;
+    bool writing = false;
+
+public:
+    /** Starts a new line for the logger named [loggerName]. */
+    void start(const char *loggerName);
+
+    /** Ends the line, which is then ready to be handed to logLine(). */
+    void finish();
+
+    const char *getText() const {
+        return text;
+    }
+
+    uint16_t getLength() const {
+        return length;
+    }
+
+    bool isWriting() const {
+        return writing;
+    }
+
+    void writeStart() {
+        writing = true;
+        mark = length;
+    }
+
+    void writeEnd() {
+        writing = false;
+    }
+
+    void writeAbort() {
+        length = mark;
+        writing = false;
+    }
+
+    uint8_t getSpace() const {
+        return maxMessage - (length - messageStart);
+    }
+
+    bool hasSpace() const {
+        return getSpace() > 0;
+    }
+
+    bool isFull() const {
+        return getSpace() == 0;
+    }
+
+    void uncheckedWrite(uint8_t b) {
+        text[length++] = b;
+    }
+};
+
+/** Returns the calling thread's own line buffer. */
+LineBuffer &lineBuffer();
+
+/**
+ * Appends a finished [line] to a lock-free ring, from which a background thread writes out batches of whole
+ * lines with one write() each. Only waits if the ring is full.
+ */
+void logLine(const LineBuffer &line);
+
+/** Waits until all lines that were logged before the call have been written. */
+void flushLog();
+
+}
+}
@@ -5,6 +5,9 @@ namespace Logging {
 template <typename T>
 struct Log;
 
+template <typename... loggers_t>
+struct LoggerList {};
+
 }
 
 namespace Loggers {
@@ -29,19 +32,26 @@ class RxState;
 class TxState;
 class FrequencyCounter;
 class Ambient;
+
+// ...and here, which gives each logger its bit in the runtime mask of MessagesSwitchable.
+typedef Logging::LoggerList<VisonicDecoder, Streams, Scanner, Serial, RS232Tx, RFM12, ESP8266, DHT11, Timing, Dallas,
+                            Main, Passive, TWI, PIR, PinChangeInterrupt, Power, RxState, TxState, FrequencyCounter,
+                            Ambient> All;
 }
 
 
 #include "Strings.hpp"
 #include "Fifo.hpp"
 #include "Streams/Format.hpp"
+#include "BinaryLog.hpp"
 #include "AtomicScope.hpp"
 #include <HAL/Atmel/Registers.hpp>
 
 #ifndef AVR
+#include "HostLogSink.hpp"
+#include "Streams/Writing.hpp"
 #include <stdarg.h>
 #include <stdio.h>
-#include <mutex>
 #endif
 
 constexpr uint8_t debugTimingMax = 32;
@@ -55,11 +65,33 @@ namespace Logging {
 
 using namespace HAL::Atmel::Registers;
 
-#ifndef AVR
 namespace Impl {
-extern std::mutex logging_mutex;
+
+template <typename logger_t, typename list_t>
+struct LoggerIndex;
+
+template <typename logger_t, typename... tail_t>
+struct LoggerIndex<logger_t, LoggerList<logger_t, tail_t...>> {
+    static constexpr uint8_t value = 0;
+};
+
+template <typename logger_t, typename head_t, typename... tail_t>
+struct LoggerIndex<logger_t, LoggerList<head_t, tail_t...>> {
+    static constexpr uint8_t value = LoggerIndex<logger_t, LoggerList<tail_t...>>::value + 1;
+};
+
+template <typename... loggers_t>
+constexpr uint8_t maskSizeOf(LoggerList<loggers_t...>) {
+    return (sizeof...(loggers_t) + 7) / 8;
+}
+
+constexpr uint8_t maskSize = maskSizeOf(Loggers::All());
+
+static_assert(maskSize <= sizeof(uint32_t), "Runtime logger mask must fit in 32 bits");
+
+/** One bit per logger in Loggers::All, set if its MessagesSwitchable messages are suppressed, so all start enabled. */
+extern volatile uint8_t disabledLoggers[maskSize];
 }
-#endif
 
 struct TimingDisabled {
     static constexpr bool isTimingEnabled() { return false; }
@@ -117,18 +149,16 @@ struct MessagesEnabled {
 #ifndef AVR
     template <typename... types>
     inline static void debug(types... args) {
-    	std::lock_guard<std::mutex> lock(Impl::logging_mutex);
-        printf("[%9s ] ", loggerName::data());
-        Fifo<250> out;
-        out.write(args...);
-        while (out.hasContent()) {
-            uint8_t ch;
-            out.read(&ch);
-            printf("%c", ch);
-        }
-        printf("\n");
+        Impl::LineBuffer &line = Impl::lineBuffer();
+        line.start(loggerName::data());
+        Streams::Impl::writeIfSpace(line, args...);
+        line.finish();
+        Impl::logLine(line);
+    }
+
+    static void flush() {
+        Impl::flushLog();
     }
-    static void flush() {}
 #else
     template <typename... types>
     inline static void debug(types... args) {
@@ -141,6 +171,89 @@ struct MessagesEnabled {
 #endif
 };
 
+/**
+ * Sends messages only while the bit of [logger_t] is set in the runtime mask (see enable() and setMask()), so
+ * diagnostics can be switched on in the field without reflashing. Checking the bit costs a single byte read. The
+ * arguments are only formatted if the logger is enabled, and to also skip evaluating expensive arguments, guard the
+ * call with isDebugEnabled(), which is constexpr false for loggers that are compiled out:
+ *
+ *     if (log::isDebugEnabled()) log::debug(F("t="), dec(measure()));
+ */
+template <typename logger_t, typename loggerName = STR("")>
+struct MessagesSwitchable: public MessagesEnabled<loggerName> {
+    static constexpr uint8_t bit = Impl::LoggerIndex<logger_t, Loggers::All>::value;
+
+    inline static bool isDebugEnabled() {
+        return (Impl::disabledLoggers[bit / 8] & (1 << (bit % 8))) == 0;
+    }
+
+    template <typename... types>
+    inline static void debug(types... args) {
+        if (isDebugEnabled()) {
+            MessagesEnabled<loggerName>::debug(args...);
+        }
+    }
+};
+
+/** Enables the messages of the switchable logger [logger_t] at runtime. */
+template <typename logger_t>
+void enable() {
+    constexpr uint8_t bit = Impl::LoggerIndex<logger_t, Loggers::All>::value;
+    AtomicScope _;
+    Impl::disabledLoggers[bit / 8] &= ~(1 << (bit % 8));
+}
+
+/** Disables the messages of the switchable logger [logger_t] at runtime. */
+template <typename logger_t>
+void disable() {
+    constexpr uint8_t bit = Impl::LoggerIndex<logger_t, Loggers::All>::value;
+    AtomicScope _;
+    Impl::disabledLoggers[bit / 8] |= (1 << (bit % 8));
+}
+
+/**
+ * Replaces the runtime mask, one bit per logger in the order of Loggers::All, e.g. as received over serial or radio,
+ * or as restored from EEPROM at startup. All switchable loggers start out enabled.
+ */
+inline void setMask(uint32_t mask) {
+    AtomicScope _;
+    for (uint8_t i = 0; i < Impl::maskSize; i++) {
+        Impl::disabledLoggers[i] = ~uint8_t(mask >> (8 * i));
+    }
+}
+
+/** Returns the runtime mask, one bit per logger in the order of Loggers::All. */
+inline uint32_t getMask() {
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < Impl::maskSize; i++) {
+        mask |= uint32_t(uint8_t(~Impl::disabledLoggers[i])) << (8 * i);
+    }
+    return mask;
+}
+
+/**
+ * Sends messages in the compact binary format of BinaryLog, to be rendered by BinaryLogDecoder on the receiving end.
+ * On the host, messages are simply printed as text.
+ */
+#ifndef AVR
+template <typename loggerName = STR("")>
+struct MessagesBinary: public MessagesEnabled<loggerName> {};
+#else
+template <typename loggerName = STR("")>
+struct MessagesBinary {
+    static constexpr bool isDebugEnabled() { return true; }
+
+    template <typename... types>
+    inline static void debug(types... args) {
+        onMessage(BinaryLog::record<loggerName>(args...));
+    }
+
+    static void flush() {
+        onFlush();
+    }
+};
+#endif
+
 template <typename T>
 struct Log: public TimingDisabled, public MessagesDisabled{
 
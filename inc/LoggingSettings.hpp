@@ -12,6 +12,15 @@ namespace Logging {
      * }
      *
      * or invoke the macro LOGGING_TO(var) with "var" being a USART TX pin, or fifo that is regularly emptied.
+     *
+     * Loggers that extend MessagesBinary instead of MessagesEnabled send compact binary records, which need
+     * BinaryLogDecoder and the firmware image to be read, e.g.
+     *
+     *     template<> class Log<Loggers::RFM12>: public MessagesBinary<STR("R")> {};
+     *
+     * Loggers that extend MessagesSwitchable can be turned on and off at runtime with Logging::setMask(), e.g.
+     *
+     *     template<> class Log<Loggers::Dallas>: public MessagesSwitchable<Loggers::Dallas, STR("Dallas")> {};
      */
 
     template<> class Log<Loggers::Timing>: public MessagesEnabled<STR("Timing")> {};
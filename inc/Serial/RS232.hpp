@@ -13,10 +13,6 @@
 namespace Serial {
 
 struct RS232 {
-private:
-    static const uint8_t prefix[];
-    static const uint8_t postfix[];
-public:
     template <typename prescaled_t, uint32_t bits_per_second = 57600>
     struct _8n1 {
         // TODO put static_assert here that errors out on bit rate errors > 3% ???
@@ -24,19 +20,20 @@ public:
         static constexpr typename prescaled_t::value_t bit_length = prescaled_t::template microseconds2counts<1000000l / bits_per_second>();
         static_assert(bit_length > prescaled_t::template microseconds2counts<30>(), "bits_per_second must be low enough so that a single bit is more than 25us, since the software serial implementation is so slow.");
 
-        static constexpr SerialConfig serialconfig = SerialConfig {
-            /* highOnIdle */ true,
-            prefix, 1,
-            Pulse(false, bit_length),
-            Pulse::empty(),
-            Pulse(true, bit_length),
-            Pulse::empty(),
-            SerialParity::NONE,
-            SerialBitOrder::LSB_FIRST,
-            postfix, 1 };
+        static constexpr bool highOnIdle = true;
+        static constexpr uint8_t prefix_bits = 1;
+        static constexpr uint32_t prefix = 0b0;         // Start bit is always low
+        static constexpr uint8_t postfix_bits = 1;
+        static constexpr uint32_t postfix = 0b1;        // Stop bit is always high
+        static constexpr SerialParity parity = SerialParity::NONE;
+        static constexpr SerialBitOrder bitOrder = SerialBitOrder::LSB_FIRST;
+
+        static constexpr Pulse zero_a() { return Pulse(false, bit_length); }
+        static constexpr Pulse zero_b() { return Pulse::empty(); }
+        static constexpr Pulse one_a() { return Pulse(true, bit_length); }
+        static constexpr Pulse one_b() { return Pulse::empty(); }
     };
 };
-
 }
 
 #endif /* RS232_HPP_ */
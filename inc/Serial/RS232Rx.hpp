@@ -0,0 +1,107 @@
+#pragma once
+
+#include "HAL/Atmel/InterruptHandlers.hpp"
+#include "Time/UnitLiterals.hpp"
+#include "Fifo.hpp"
+#include "AtomicScope.hpp"
+
+namespace Serial {
+
+namespace Impl {
+
+using namespace HAL::Atmel::InterruptHandlers;
+using namespace Time;
+
+/**
+ * Software 8N1 serial receiver. The falling edge of the start bit is caught by a pin change interrupt,
+ * after which the pin interrupt is turned off and all bits are sampled in their middle by a timer
+ * comparator. The pin interrupt is re-enabled halfway the stop bit, so back-to-back bytes are received.
+ *
+ * The comparator should not be shared with another user (e.g. a PulseCounter), but can run on the
+ * same timer as one.
+ */
+template <typename pin_t, typename comparator_t, uint32_t baudrate, uint8_t fifoSize>
+class RS232Rx {
+public:
+    typedef RS232Rx<pin_t, comparator_t, baudrate, fifoSize> This;
+    typedef typename comparator_t::value_t count_t;
+
+    static constexpr count_t bitLength = dividedBy<baudrate>((1_s).toCountsOn<comparator_t>()).getValue();
+    static_assert(bitLength > 5, "Bit length is too low. Decrease baudrate, or decrease timer prescaler.");
+
+    /** From the start bit's falling edge to the middle of the first data bit */
+    static constexpr uint32_t startOffset = uint32_t(bitLength) * 3 / 2;
+    static_assert(startOffset <= count_t(-1), "One and a half bit must fit in the timer. Increase timer prescaler.");
+
+private:
+    pin_t * const pin;
+    comparator_t * const comparator;
+    Fifo<fifoSize> fifo;
+
+    volatile uint8_t bitsLeft = 0;
+    volatile uint8_t current = 0;
+    volatile uint8_t framingErrors = 0;
+
+    void onPinChange() {
+        if (bitsLeft != 0 || pin->isHigh()) {
+            return; // only the falling edge of a start bit is interesting
+        }
+        pin->interruptOff();
+        comparator->setTarget(comparator->getValue() + count_t(startOffset));
+        comparator->interruptOn();
+        bitsLeft = 9; // 8 data bits, then the stop bit
+    }
+
+    void onComparator() {
+        const bool high = pin->isHigh();
+        bitsLeft--;
+        if (bitsLeft > 0) {
+            comparator->setTarget(comparator->getTarget() + bitLength);
+            current >>= 1;
+            if (high) {
+                current |= 0x80;
+            }
+        } else {
+            comparator->interruptOff();
+            if (high) {
+                fifo.fastwrite(current);
+            } else {
+                framingErrors++;
+            }
+            pin->interruptOnChange();
+        }
+    }
+
+public:
+    typedef On<This, typename pin_t::INT, &This::onPinChange,
+            On<This, typename comparator_t::INT, &This::onComparator>> Handlers;
+
+    RS232Rx(pin_t &p, comparator_t &c): pin(&p), comparator(&c) {
+        comparator->interruptOff();
+        pin->configureAsInputWithPullup();
+        pin->interruptOnChange();
+    }
+
+    AbstractFifo::In in() {
+        return fifo.in();
+    }
+
+    /** Returns the number of bytes that were dropped since the stop bit was not high */
+    uint8_t getFramingErrors() const {
+        return framingErrors;
+    }
+
+    /** Returns the number of bytes that were dropped because the fifo was full */
+    uint8_t getOverflows() const {
+        return fifo.getAbortedWrites();
+    }
+};
+
+}
+
+template <uint32_t baudrate = 9600, uint8_t fifoSize = 32, typename pin_t, typename comparator_t>
+Impl::RS232Rx<pin_t, comparator_t, baudrate, fifoSize> RS232Rx(pin_t &pin, comparator_t &comparator) {
+    return { pin, comparator };
+}
+
+}
@@ -7,8 +7,8 @@
 #include "HAL/Atmel/InterruptHandlers.hpp"
 #include "HAL/Atmel/Registers.hpp"
 #include "Logging.hpp"
-
-#define SAFE
+#include "Strings.hpp"
+#include "HAL/attributes.hpp"
 
 namespace Serial {
 
@@ -20,6 +20,56 @@ using namespace HAL::Atmel::InterruptHandlers;
 using namespace Time;
 using namespace Streams;
 
+/**
+ * For every byte value, the RS232 frame (start bit, 8 data bits LSB first, stop bit) as run lengths
+ * in bits, 3 bits per run, first run in the lowest bits. Runs longer than 4 bits are split as [4, 0, rest],
+ * where 0 marks the continuation of a long pulse, so a run always fits an 8-bit timer. Once all runs have
+ * been shifted out, the schedule is 0.
+ */
+struct RS232Schedules {
+    uint32_t schedule[256];
+
+    static constexpr uint32_t encode(uint8_t byte) {
+        const uint16_t frame = 0x200 | (uint16_t(byte) << 1);
+        uint32_t result = 0;
+        uint8_t shift = 0;
+        uint8_t run = 1;
+        bool level = false;
+        for (uint8_t i = 1; i < 10; i++) {
+            const bool bit = ((frame >> i) & 1) != 0;
+            if (bit != level) {
+                result |= uint32_t(run) << shift;
+                shift += 3;
+                level = bit;
+                run = 1;
+            } else if (run < 4) {
+                run++;
+            } else {
+                result |= uint32_t(run) << shift;
+                shift += 6;
+                run = 1;
+            }
+        }
+        return result | (uint32_t(run) << shift);
+    }
+
+    constexpr RS232Schedules(): schedule() {
+        for (uint16_t b = 0; b < 256; b++) {
+            schedule[b] = encode(b);
+        }
+    }
+};
+
+extern const RS232Schedules rs232Schedules PROGMEM;
+
+inline uint32_t rs232Schedule(uint8_t byte) {
+    const uint8_t *p = (const uint8_t *) (rs232Schedules.schedule + byte);
+    return uint32_t(pgm_read_byte(p)) |
+          (uint32_t(pgm_read_byte(p + 1)) << 8) |
+          (uint32_t(pgm_read_byte(p + 2)) << 16) |
+          (uint32_t(pgm_read_byte(p + 3)) << 24);
+}
+
 template <typename pin_t, uint32_t baudrate, uint8_t fifoSize>
 class RS232Tx {
 	typedef Logging::Log<Loggers::RS232Tx> log;
@@ -35,92 +85,20 @@ public:
 	Fifo<fifoSize> fifo;
 
 	volatile bool transmitting = false;
-	volatile count_t lengths[10] = {}; // worst case start bit + 8 up/down bits + stop bit
-	volatile uint8_t max = 0;
-	volatile uint8_t pos = 0;
+	uint32_t schedule = 0;          // remaining runs of the current byte, see RS232Schedules
 	volatile bool outHigh = true;
 
+	static constexpr bool isLong(uint32_t s) {
+		return (s != 0) && ((s & 7) == 0);
+	}
+
 	inline __attribute__((always_inline)) void nextByte(uint8_t byte) {
     	log::debug(F("next "), dec(uint16_t(pin->timerComparator().getValue())));
 
-		max = 0;
-		bool high = false;  // is the output currently high?
-		lengths[max] = 1;     // we're low during the start bit
-		for (uint8_t bit = 0; bit < 3; bit++) {
-			// bits 0..2 can't produce a length > 4
-			//std::cout << "bit " << int(bit) << ": " << ((byte & 1) != 0) << "/" << high << std::endl;
-			if (((byte & 1) != 0) != high) {
-				high = !high;
-				max++;
-				lengths[max] = 1;
-			} else {
-				lengths[max]++;
-			}
-			byte >>= 1;
-		}
-		for (uint8_t bit = 3; bit < 7; bit++) {
-			// bits 3..6 need a length check
-			//std::cout << "bit " << int(bit) << ": " << ((byte & 1) != 0) << "/" << high << std::endl;
-			if (((byte & 1) != 0) != high) {
-				high = !high;
-				max++;
-				lengths[max] = 1;
-			} else {
-				if (lengths[max] < 4) {
-					lengths[max]++;
-				} else {
-					max++;
-					lengths[max] = 0;
-					max++;
-					lengths[max] = 1;
-				}
-			}
-			byte >>= 1;
-		}
-		// last data bit
-		//std::cout << "bit 7: " << ((byte & 1) != 0) << "/" << high << std::endl;
-		if (((byte & 1) != 0) != high) {
-			high = !high;
-			max++;
-			lengths[max] = 1;
-		} else {
-			if (lengths[max] < 4) {
-				lengths[max]++;
-			} else {
-				max++;
-				lengths[max] = 0;
-				max++;
-				lengths[max] = 1;
-			}
-		}
-		// stop bit (must be high)
-		if (byte & 1) {
-			// last data bit was also high -> lengthen
-			if (lengths[max] < 4) {
-				lengths[max]++;
-			} else {
-				max++;
-				lengths[max] = 0;
-				max++;
-				lengths[max] = 1;
-			}
-		} else {
-			// last data bit was low -> new transition
-			max++;
-			lengths[max] = 1;
-		}
-		for (uint8_t i = 0; i <= max; i++) {
-			//std::cout << int(i) << ": " << int(lengths[i]) << " -> " << int(bitLengths[lengths[i]]) << std::endl;
-			lengths[i] = bitLengths[lengths[i]];
-		}
-		pos = 0;
-
 		AtomicScope _;
+		schedule = rs232Schedule(byte);
 		auto startValue = pin->timerComparator().getValue();
-		//log::debug('s', dec(startValue), 'l', dec(lengths[pos]));
-		//std::cout << "start: " << int(startValue) << std::endl;
-		//std::cout << "length: " << int(lengths[pos]) << std::endl;
-		pin->timerComparator().setTarget(startValue + lengths[pos]);
+		pin->timerComparator().setTarget(startValue + bitLengths[schedule & 7]);
 
 		// We make the timer do the transition. Assuming high right now.
 		pin->timerComparator().setOutput(NonPWMOutputMode::low_on_match);
@@ -128,8 +106,7 @@ public:
 		pin->setLow(); // start bit
 		outHigh = false;
 
-		//log::debug(dec(lengths[0]), ' ', dec(lengths[1]), ' ', dec(lengths[2]), ' ', dec(lengths[3]), ' ', dec(lengths[4]));
-		if ((max > pos) && (lengths[pos+1] == 0)) {
+		if (isLong(schedule >> 3)) {
 			// first pulse is a long one
 			pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
 		} else {
@@ -138,58 +115,47 @@ public:
 		pin->timerComparator().interruptOn();
 	}
 
+	void stop() {
+		transmitting = false;
+		pin->timerComparator().interruptOff();
+		pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
+		pin->setHigh();
+	}
+
     inline __attribute__((always_inline)) void onComparator() {
-    	log::debug('i', ' ', dec(pos), ' ', dec(lengths[pos]), ' ', '0' + outHigh);
-    	//std::cout << "1. pos: " << int(pos) << " max: " << int(max) << std::endl;
     	log::timeStart();
-#ifdef SAFE
+#ifdef RS232TX_SAFE
     	if (!transmitting) {
         	log::debug(F("X1"));
-    		pin->timerComparator().interruptOff();
-			pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
-    		pin->setHigh();
+        	stop();
     		log::timeEnd();
     		return;
     	}
 #endif
 
-    	pos++;
-    	if (pos > max) {
+    	schedule >>= 3;
+    	if (schedule == 0) {
     		uint8_t byte;
     		if (fifo.fastread(byte)) {
     			nextByte(byte);
     		} else {
             	log::debug(F("done. "), dec(uint16_t(pin->timerComparator().getValue())));
-        		transmitting = false;
-        		pin->timerComparator().interruptOff();
-    			pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
-        		pin->setHigh();
+            	stop();
     		}
     		log::timeEnd();
 			return;
     	}
 
-    	if (lengths[pos] == 0) {
-#ifdef SAFE
+    	if ((schedule & 7) == 0) {
+#ifdef RS232TX_SAFE
     		if (pin->timerComparator().getOutput() != NonPWMOutputMode::disconnected) {
     			log::debug('2');
     		}
 #endif
     		// we're entering the second half of a long pulse. Simply toggle on the next one.
-    		pos++;
-#ifdef SAFE
-    		if (pos > max) {
-    			// this shouldn't happen
-        		transmitting = false;
-        		pin->timerComparator().interruptOff();
-    			pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
-        		pin->setHigh();
-        		log::timeEnd();
-        		return;
-    		}
-#endif
+    		schedule >>= 3;
     	} else {
-#ifdef SAFE
+#ifdef RS232TX_SAFE
     		if (pin->timerComparator().getOutput() == NonPWMOutputMode::disconnected) {
     			log::debug('3');
     		}
@@ -198,37 +164,29 @@ public:
     		outHigh = !outHigh;
     	}
 
-    	pin->timerComparator().setTarget(pin->timerComparator().getTarget() + lengths[pos]);
-    	//std::cout << "2. pos: " << int(pos) << " max: " << int(max) << std::endl;
-		if ((pos < max) && (lengths[pos+1] == 0)) {
-	    	//log::debug('L', dec(pos), '@', '0' + outHigh, ' ', dec(pin->timerComparator().getTarget()));
-
+    	pin->timerComparator().setTarget(pin->timerComparator().getTarget() + bitLengths[schedule & 7]);
+    	const uint32_t next = schedule >> 3;
+		if (isLong(next)) {
 			// next pulse is a long one
 			pin->setHigh(outHigh);
 			pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
-		} else {
-			if (pos < max) {
-				// normal bit
-				if (pin->timerComparator().getOutput() == NonPWMOutputMode::disconnected) {
-			    	//log::debug('C', dec(pos), ' ', dec(pin->timerComparator().getTarget()));
-					// copy current output state
-					pin->timerComparator().setOutput(outHigh ? NonPWMOutputMode::high_on_match : NonPWMOutputMode::low_on_match);
-					pin->timerComparator().applyOutput();
-					pin->timerComparator().setOutput(NonPWMOutputMode::toggle_on_match);
-				} else {
-			    	//log::debug('N', dec(pos), '@', '0' + outHigh, ' ', dec(pin->timerComparator().getTarget()));
-				}
-			} else {
-		    	//log::debug('S', dec(pos), ' ', dec(pin->timerComparator().getTarget()));
-	        	// Attempt to force OC0A output high, so it latches high on the next byte.
-				pin->timerComparator().setOutput(NonPWMOutputMode::high_on_match);
+		} else if (next != 0) {
+			// normal bit
+			if (pin->timerComparator().getOutput() == NonPWMOutputMode::disconnected) {
+				// copy current output state
+				pin->timerComparator().setOutput(outHigh ? NonPWMOutputMode::high_on_match : NonPWMOutputMode::low_on_match);
 				pin->timerComparator().applyOutput();
-
-				// stop bit -> keep high after we're done. Pin state should be good to go.
-				pin->setHigh();
-				pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
-				outHigh = true;
+				pin->timerComparator().setOutput(NonPWMOutputMode::toggle_on_match);
 			}
+		} else {
+			// Attempt to force OC0A output high, so it latches high on the next byte.
+			pin->timerComparator().setOutput(NonPWMOutputMode::high_on_match);
+			pin->timerComparator().applyOutput();
+
+			// stop bit -> keep high after we're done. Pin state should be good to go.
+			pin->setHigh();
+			pin->timerComparator().setOutput(NonPWMOutputMode::disconnected);
+			outHigh = true;
 		}
 		log::timeEnd();
     }
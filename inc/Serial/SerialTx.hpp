@@ -22,93 +22,202 @@ enum class SerialBitOrder {
     LSB_FIRST, MSB_FIRST
 };
 
+/**
+ * Compile-time serial configuration. All timing and framing is derived from [format_t], which must declare:
+ *
+ *   static constexpr bool highOnIdle;
+ *   static constexpr uint8_t prefix_bits;     static constexpr uint32_t prefix;
+ *   static constexpr uint8_t postfix_bits;    static constexpr uint32_t postfix;
+ *   static constexpr SerialParity parity;
+ *   static constexpr SerialBitOrder bitOrder;
+ *   static constexpr Pulse zero_a(), zero_b(), one_a(), one_b();
+ *
+ * Prefix and postfix bits are ALWAYS sent out LSB first, regardless of the configured data bitOrder.
+ * A B pulse of Pulse::empty() means that bit value is sent as a single pulse.
+ */
+template <typename format_t>
 struct SerialConfig {
-    bool highOnIdle;
+    static constexpr bool highOnIdle = format_t::highOnIdle;
+    static constexpr uint8_t prefix_bits = format_t::prefix_bits;
+    static constexpr uint32_t prefix = format_t::prefix;
+    static constexpr uint8_t postfix_bits = format_t::postfix_bits;
+    static constexpr uint32_t postfix = format_t::postfix;
+    static constexpr SerialParity parity = format_t::parity;
+    static constexpr SerialBitOrder bitOrder = format_t::bitOrder;
 
-    const uint8_t *prefix;   /* Prefix bits are ALWAYS sent out LSB first, regardless of the configured data bitOrder */
-    uint8_t prefix_bits;
+    static_assert(prefix_bits <= 32 && postfix_bits <= 32, "prefix and postfix can be at most 32 bits");
 
-    Pulse zero_a;
-    Pulse zero_b;
-    Pulse one_a;
-    Pulse one_b;
+    static constexpr bool hasParity() {
+        return parity != SerialParity::NONE;
+    }
 
-    SerialParity parity;
-    SerialBitOrder bitOrder;
+    /** Number of bits that each data byte is sent as, including the parity bit. */
+    static constexpr uint8_t frame_bits = hasParity() ? 9 : 8;
 
-    const uint8_t *postfix; /* Postfix bits are ALWAYS sent out LSB first, regardless of the configured data bitOrder */
-    uint8_t postfix_bits;
+    /** Returns the A or B pulse to send for a bit. */
+    static constexpr Pulse pulse(bool bit, bool b) {
+        return bit ? (b ? format_t::one_b()  : format_t::one_a())
+                   : (b ? format_t::zero_b() : format_t::zero_a());
+    }
 
-    bool hasParity() {
-        return parity != SerialParity::NONE;
+    static constexpr bool hasPulseB(bool bit) {
+        return pulse(bit, true).getDuration() != 0;
     }
 
-    bool prefixBit(uint8_t bitIndex) const;
+    static constexpr uint8_t reverse(uint8_t b) {
+        return reverse4(uint8_t((b >> 4) | (b << 4)));
+    }
 
-    bool postfixBit(uint8_t bitIndex) const;
+    /** Returns the bits to send for [b], in transmission order (LSB is sent first), including parity. */
+    static uint16_t frame(uint8_t b) {
+        uint16_t result = (bitOrder == SerialBitOrder::LSB_FIRST) ? b : reverse(b);
+        if (parity == SerialParity::EVEN) {
+            if (parity_even_bit(b)) result |= 0x100;
+        } else if (parity == SerialParity::ODD) {
+            if (!parity_even_bit(b)) result |= 0x100;
+        }
+        return result;
+    }
 
-    bool hasPulseBForBit(bool bit) const;
+private:
+    static constexpr uint8_t reverse4(uint8_t b) {
+        return reverse2(uint8_t(((b & 0xCC) >> 2) | ((b & 0x33) << 2)));
+    }
+    static constexpr uint8_t reverse2(uint8_t b) {
+        return uint8_t(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+    }
 };
 
-//TODO should be private. We could do without AFTER.
-enum class SerialBitState: uint8_t {
-    BEFORE, PREFIX, DATA_LSB, DATA_MSB, PARITY_BIT, POSTFIX, AFTER
-};
-enum class SerialPulseState: uint8_t {
-    A, B
-};
+namespace Impl {
 
-class AbstractSerialSource {
+/**
+ * Turns a word of bits into pulses, using the A/B pulse table of config_t. Subclasses refill [bits] once
+ * [bitsLeft] reaches zero.
+ */
+template <typename config_t>
+class SerialBitSource {
 protected:
-    SerialConfig *config = nullptr;
-
-    SerialBitState bitState = SerialBitState::BEFORE;
-    uint8_t bitIndex = 0;
-    bool currentBit = false;
-    SerialPulseState pulseState = SerialPulseState::A;
-    uint8_t currentByte, currentByteBits = 0;
+    uint32_t bits = 0;
+    uint8_t bitsLeft = 0;
+    bool pulseB = false;
+
+    void load(uint32_t _bits, uint8_t count) {
+        bits = _bits;
+        bitsLeft = count;
+        pulseB = false;
+    }
 
-    bool getCurrentBit();
+    Pulse nextBitPulse() {
+        const bool bit = bits & 1;
+        if (!pulseB && config_t::hasPulseB(bit)) {
+            pulseB = true;
+            return config_t::pulse(bit, false);
+        }
+        const Pulse result = config_t::pulse(bit, pulseB);
+        pulseB = false;
+        bits >>= 1;
+        bitsLeft--;
+        return result;
+    }
 
-    Pulse getCurrentPulse() const;
 public:
-    bool isHighOnIdle() {
-        return config->highOnIdle;
+    static constexpr bool isHighOnIdle() {
+        return config_t::highOnIdle;
     }
 };
 
+}
+
 /**
- * Outputs a single chunk at a time, from a chunked fifo. Every chunk in the fifo
- * should start with a pointer to a SerialConfig settings for that chunk; the remaining
- * bytes are the serial data to send.
+ * Outputs a single chunk at a time, from a chunked fifo, as prefix, all data bytes (each with optional parity),
+ * and postfix. If the fifo already is reading when the next chunk is started, that read is continued, so a caller
+ * can consume a header of its own first.
  */
-class ChunkPulseSource: public AbstractSerialSource {
-    AbstractChunkedFifo *fifo;
+template <typename config_t>
+class ChunkPulseSource: public Impl::SerialBitSource<config_t> {
+    enum class State: uint8_t { BEFORE, PREFIX, DATA, POSTFIX, AFTER };
 
-    void nextDataByte();
-
-    void nextBit();
+    AbstractChunkedFifo *fifo;
+    State state = State::BEFORE;
+
+    void nextSegment() {
+        switch (state) {
+        case State::BEFORE:
+            fifo->readStart();
+            if (fifo->isReading()) {
+                state = State::PREFIX;
+                this->load(config_t::prefix, config_t::prefix_bits);
+            } else {
+                state = State::AFTER;
+            }
+            break;
+        case State::PREFIX:
+        case State::DATA:
+            if (fifo->hasReadAvailable()) {
+                uint8_t b;
+                fifo->uncheckedRead(b);
+                state = State::DATA;
+                this->load(config_t::frame(b), config_t::frame_bits);
+            } else {
+                state = State::POSTFIX;
+                this->load(config_t::postfix, config_t::postfix_bits);
+            }
+            break;
+        case State::POSTFIX:
+        case State::AFTER:
+            state = State::AFTER;
+            break;
+        }
+    }
 
 public:
     ChunkPulseSource(AbstractChunkedFifo &_fifo): fifo(&_fifo) {}
 
-    Pulse getNextPulse();
+    Pulse getNextPulse() {
+        AtomicScope _;
+
+        while (this->bitsLeft == 0 && state != State::AFTER) {
+            nextSegment();
+        }
+        if (state == State::AFTER) {
+            fifo->readEnd();
+            state = State::BEFORE;
+            return Pulse::empty();
+        }
+        return this->nextBitPulse();
+    }
 };
 
 /**
- * Outputs a single byte at a time. from a fifo. The serial config is set at
- * construction time.
+ * Outputs a single byte at a time from a fifo, each byte framed by prefix, optional parity, and postfix.
  */
-class StreamPulseSource: public AbstractSerialSource {
+template <typename config_t>
+class StreamPulseSource: public Impl::SerialBitSource<config_t> {
+    static_assert(config_t::prefix_bits + config_t::frame_bits + config_t::postfix_bits <= 32,
+            "StreamPulseSource sends each byte as a single word of at most 32 bits");
+
+    static constexpr uint8_t prefixedBits = config_t::prefix_bits + config_t::frame_bits;
+    static constexpr uint32_t postfix = (config_t::postfix_bits > 0) ? config_t::postfix << prefixedBits : 0;
+
     AbstractFifo *fifo;
 
-    void nextBit();
 public:
-    StreamPulseSource(AbstractFifo &_fifo, SerialConfig &_config): fifo(&_fifo) {
-        config = &_config;
+    StreamPulseSource(AbstractFifo &_fifo): fifo(&_fifo) {}
+
+    Pulse getNextPulse() {
+        AtomicScope _;
+
+        if (this->bitsLeft == 0) {
+            uint8_t b;
+            if (!fifo->fastread(b)) {
+                return Pulse::empty();
+            }
+            this->load(config_t::prefix |
+                       (uint32_t(config_t::frame(b)) << config_t::prefix_bits) |
+                       postfix, prefixedBits + config_t::postfix_bits);
+        }
+        return this->nextBitPulse();
     }
-
-    Pulse getNextPulse();
 };
 
 }
@@ -25,6 +25,14 @@ struct Hexadecimal {
     constexpr explicit Hexadecimal(T v): value(v) {}
 };
 
+/** An integer that holds a decimal number with [scale] digits after the point, e.g. 235 for 23.5 when [scale] is 1. */
+template <typename T, uint8_t scale>
+struct FixedPoint {
+    static_assert(scale <= 9, "Fixed point numbers can have at most 9 digits after the point");
+    const T value;
+    constexpr explicit FixedPoint(T v): value(v) {}
+};
+
 template <typename int_t>
 struct ArraySlice {
     const int_t *array;
@@ -36,6 +44,25 @@ class Format {
 public:
     typedef bool (write_f)(void *ctx, uint8_t value);
 
+    /** Number of digits of the largest uint32_t */
+    static constexpr uint8_t maxDecimalDigits = 10;
+    /** Longest text that toDecimal() produces, i.e. the digits and sign of the smallest int32_t */
+    static constexpr uint8_t maxDecimalLength = maxDecimalDigits + 1;
+
+    /** Puts the decimal digits of [v] into [out], which must have room for maxDecimalLength, returning their count. */
+    static uint8_t toDecimal(char *out, uint32_t v);
+    static uint8_t toDecimal(char *out, int32_t v);
+
+    /** Longest text that toFixedPoint() produces, i.e. toDecimal()'s and the point */
+    static constexpr uint8_t maxFixedPointLength = maxDecimalLength + 1;
+
+    /**
+     * Puts [v] into [out] as a decimal number with [scale] digits after the point, with a leading "0" if there are no
+     * others before the point. [out] must have room for maxFixedPointLength. Returns the number of characters.
+     */
+    static uint8_t toFixedPoint(char *out, uint32_t v, uint8_t scale);
+    static uint8_t toFixedPoint(char *out, int32_t v, uint8_t scale);
+
     static bool format(write_f write, void *ctx, Impl::Decimal<uint8_t> v);
     static bool format(write_f write, void *ctx, Impl::Decimal<int8_t> v);
     static bool format(write_f write, void *ctx, Impl::Decimal<uint16_t> v);
@@ -62,6 +89,15 @@ inline Impl::Decimal<Impl::ArraySlice<int_t>> constexpr Decimal(const int_t *arr
     return Impl::Decimal<Impl::ArraySlice<int_t>> { { array, first, uint8_t(first + count) } };
 }
 
+/**
+ * Writes [v] as a decimal number with [scale] digits after the point, e.g. FixedPoint<1>(int16_t(-235)) as "-23.5",
+ * or reads such a number into the integer pointed to by [v].
+ */
+template <uint8_t scale, typename T>
+inline Impl::FixedPoint<T, scale> constexpr FixedPoint(T v) {
+    return Impl::FixedPoint<T, scale> { v };
+}
+
 template <typename T>
 inline Impl::Hexadecimal<T> constexpr Hexadecimal(T v) {
     return Impl::Hexadecimal<T> { v };
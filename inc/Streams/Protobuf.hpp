@@ -4,13 +4,15 @@
 #include "Varint.hpp"
 #include "WritingProtobuf.hpp"
 #include "Option.hpp"
+#include "Strings.hpp"
 #include "Streams/WritingN.hpp"
 
 /**
- * Protobuf implementation that doesn't rely on protoc. Limitiations:
- * - Only varints
- * - Only zigzag encoding for signed ints
- * - Only signed/unsigned ints up to 32 bit
+ * Protobuf implementation that doesn't rely on protoc. Supports varints, fixed32/fixed64 (including float),
+ * bytes and strings in fixed-size arrays, and repeated scalars in fixed-capacity arrays. Limitations:
+ * - Only zigzag encoding for signed varints
+ * - Varints only up to 32 bit
+ * - Repeated fields are written packed, but can be read packed or unpacked
  * - All fields are always optional
  */
 
@@ -77,26 +79,61 @@ ReadResult readVarint(fifo_t &fifo, uint32_t &value) {
 	return ReadResult::Valid;
 }
 
+template <typename fifo_t, typename T>
+ReadResult readFixed(fifo_t &fifo, T &value) {
+	if (fifo.getReadAvailable() < sizeof(T)) {
+		return ReadResult::Partial;
+	}
+	value = 0;
+	for (uint8_t i = 0; i < sizeof(T); i++) {
+		uint8_t data;
+		fifo.uncheckedRead(data);
+		value |= T(data) << (8 * i);
+	}
+	return ReadResult::Valid;
+}
+
+template <typename fifo_t>
+ReadResult skip(fifo_t &fifo, uint32_t length) {
+	if (fifo.getReadAvailable() < length) {
+		return ReadResult::Partial;
+	}
+	for (uint8_t i = 0; i < length; i++) {
+		uint8_t data;
+		fifo.uncheckedRead(data);
+	}
+	return ReadResult::Valid;
+}
+
+/** Maximum length of a field that has no upper bound, which will never fit a fifo. */
+constexpr uint16_t UNBOUNDED = 0xFFFF;
+
+constexpr uint16_t saturatedSum(uint32_t a, uint32_t b) {
+    return (a + b > UNBOUNDED) ? UNBOUNDED : a + b;
+}
+
+/** Looks up [protocol]::maxLength, which is only present on protobuf messages. */
+template <typename protocol, typename check = void>
+struct MaxLengthOf {
+    static constexpr uint16_t value = UNBOUNDED;
+};
+
+template <typename protocol>
+struct MaxLengthOf<protocol, decltype(void(protocol::maxLength))> {
+    static constexpr uint16_t value = protocol::maxLength;
+};
+
 template <typename This, typename... fields>
 struct Fields {
     static constexpr uint8_t maxFieldIdx = 0;
 
     typedef uint8_t presence_t[maxFieldIdx + 1];
 
-    static ReadResult assignField(This *t, uint8_t field, uint32_t result) {
-        // no more fields remaining, i.e. ignore this field, since we don't know about it or it's in the wrong format
-        return ReadResult::Valid;
-    }
-
-    template <typename fifo_t>
-    static ReadResult readNestedField(fifo_t &fifo, This *t, uint8_t field, uint32_t length) {
-        // no more fields remaining, i.e. ignore this field, since we don't know about it or it's in the wrong format
-        return ReadResult::Valid;
-    }
-
     static void initPresence(This *t, uint8_t *p) {}
 
     static constexpr uint16_t length(const This *t) { return 0; }
+
+    static constexpr uint16_t maxLength = 0;
 };
 
 template <typename This, typename head, typename... tail>
@@ -112,21 +149,33 @@ struct Fields<This, head, tail...> {
         Fields<This, tail...>::initPresence(t, p);
     }
 
-    static ReadResult assignField(This *t, uint8_t fieldIdx, uint32_t result) {
-        return (fieldIdx == head::fieldIdx)
-            ? head::assign(t, result)
-            : Fields<This, tail...>::assignField(t, fieldIdx, result);
+    static constexpr uint16_t length(const This *t) {
+        return head::length(t) + Fields<This, tail...>::length(t);
     }
 
-    template <typename fifo_t>
-    static ReadResult readNestedField(fifo_t &fifo, This *t, uint8_t fieldIdx, uint32_t length) {
-        return (fieldIdx == head::fieldIdx)
-            ? head::readNested(fifo, t, length)
-            : Fields<This, tail...>::readNestedField(fifo, t, fieldIdx, length);
+    static constexpr uint16_t maxLength = saturatedSum(head::maxLength, Fields<This, tail...>::maxLength);
+};
+
+/**
+ * Reading behaviour for all wire types a field doesn't expect: a sender that uses the wrong type for a field is invalid.
+ */
+template <typename This>
+struct WireMismatch {
+    static ReadResult assign(This *t, uint32_t value) {
+        return ReadResult::Invalid;
     }
 
-    static constexpr uint16_t length(const This *t) {
-        return head::length(t) + Fields<This, tail...>::length(t);
+    static ReadResult assignFixed32(This *t, uint32_t value) {
+        return ReadResult::Invalid;
+    }
+
+    static ReadResult assignFixed64(This *t, uint64_t value) {
+        return ReadResult::Invalid;
+    }
+
+    template <typename fifo_t>
+    static ReadResult readNested(fifo_t &fifo, This *t, const uint32_t count) {
+        return ReadResult::Invalid;
     }
 };
 
@@ -140,10 +189,11 @@ struct Varint {
 };
 
 template <typename This, uint8_t _fieldIdx, typename T, T This::*field>
-struct UnsignedVarint
+struct UnsignedVarint: public WireMismatch<This>
 {
     static constexpr uint8_t fieldIdx = _fieldIdx;
     static constexpr uint8_t initialPresence = 1;
+    static constexpr uint8_t maxLength = 1 + varint_max_size(sizeof(T));
 
     static void initialize(This *t) {}
 
@@ -172,10 +222,11 @@ struct UnsignedVarint
 };
 
 template <typename This, uint8_t _fieldIdx, typename T, Option<T> This::*field>
-struct OptionUnsignedVarint
+struct OptionUnsignedVarint: public WireMismatch<This>
 {
     static constexpr uint8_t fieldIdx = _fieldIdx;
     static constexpr uint8_t initialPresence = 0;
+    static constexpr uint8_t maxLength = 1 + varint_max_size(sizeof(T));
 
     static void initialize(This *t) {
         (t->*field) = none();
@@ -231,10 +282,11 @@ template <typename This, uint8_t _fieldIdx, Option<uint32_t> This::*field>
 struct Varint<This, _fieldIdx, Option<uint32_t>, field>: public OptionUnsignedVarint<This, _fieldIdx, uint32_t, field> {};
 
 template <typename This, uint8_t _fieldIdx, typename T, T This::*field>
-struct SignedVarint
+struct SignedVarint: public WireMismatch<This>
 {
     static constexpr uint8_t fieldIdx = _fieldIdx;
     static constexpr uint8_t initialPresence = 1;
+    static constexpr uint8_t maxLength = 1 + varint_max_size(sizeof(T));
 
     static void initialize(This *t) {}
 
@@ -264,10 +316,11 @@ struct SignedVarint
 };
 
 template <typename This, uint8_t _fieldIdx, typename T, Option<T> This::*field>
-struct OptionSignedVarint
+struct OptionSignedVarint: public WireMismatch<This>
 {
     static constexpr uint8_t fieldIdx = _fieldIdx;
     static constexpr uint8_t initialPresence = 0;
+    static constexpr uint8_t maxLength = 1 + varint_max_size(sizeof(T));
 
     static void initialize(This *t) {
         (t->*field) = none();
@@ -324,9 +377,10 @@ template <typename This, uint8_t _fieldIdx, Option<int32_t> This::*field>
 struct Varint<This, _fieldIdx, Option<int32_t>, field>: public OptionSignedVarint<This, _fieldIdx, int32_t, field> {};
 
 template <typename This, uint8_t _fieldIdx, typename U, U This::*field, typename protocol = typename U::DefaultProtocol>
-struct SubMessage {
+struct SubMessage: public WireMismatch<This> {
     static constexpr uint8_t fieldIdx = _fieldIdx;
     static constexpr uint8_t initialPresence = 1;
+    static constexpr uint16_t maxLength = MaxLengthOf<protocol>::value;
 
     template <typename fifo_t>
     static ReadResult readNested(fifo_t &fifo, This *t, uint32_t length) {
@@ -349,6 +403,354 @@ struct SubMessage {
     }
 };
 
+inline uint32_t fixedBits(uint32_t v) { return v; }
+inline uint32_t fixedBits(int32_t v) { return v; }
+inline uint32_t fixedBits(float v) { return floatBits(v); }
+inline uint64_t fixedBits(uint64_t v) { return v; }
+inline uint64_t fixedBits(int64_t v) { return v; }
+
+inline void fromFixedBits(uint32_t bits, uint32_t &v) { v = bits; }
+inline void fromFixedBits(uint32_t bits, int32_t &v) { v = bits; }
+inline void fromFixedBits(uint32_t bits, float &v) { v = bitsToFloat(bits); }
+inline void fromFixedBits(uint64_t bits, uint64_t &v) { v = bits; }
+inline void fromFixedBits(uint64_t bits, int64_t &v) { v = bits; }
+
+/**
+ * Message part that represents a uint32_t, int32_t or float as fixed32.
+ */
+template <typename This, uint8_t _fieldIdx, typename T, T This::*field>
+struct Fixed32: public WireMismatch<This>
+{
+    static_assert(sizeof(T) == 4, "Only 32-bit types can be fixed32");
+
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+    static constexpr uint8_t initialPresence = 1;
+    static constexpr uint8_t maxLength = 5;
+
+    static void initialize(This *t) {}
+
+    static ReadResult assignFixed32(This *t, uint32_t value) {
+        fromFixedBits(value, t->*field);
+        return ReadResult::Valid;
+    }
+
+    static Streams::Protobuf::Fixed32<_fieldIdx> forWriting(const This *t) {
+        return fixedBits(t->*field);
+    }
+
+    static uint8_t length(const This *t) {
+        return 5;
+    }
+};
+
+/**
+ * Message part that represents a uint64_t or int64_t as fixed64.
+ */
+template <typename This, uint8_t _fieldIdx, typename T, T This::*field>
+struct Fixed64: public WireMismatch<This>
+{
+    static_assert(sizeof(T) == 8, "Only 64-bit types can be fixed64");
+
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+    static constexpr uint8_t initialPresence = 1;
+    static constexpr uint8_t maxLength = 9;
+
+    static void initialize(This *t) {}
+
+    static ReadResult assignFixed64(This *t, uint64_t value) {
+        fromFixedBits(value, t->*field);
+        return ReadResult::Valid;
+    }
+
+    static Streams::Protobuf::Fixed64<_fieldIdx> forWriting(const This *t) {
+        return fixedBits(t->*field);
+    }
+
+    static uint8_t length(const This *t) {
+        return 9;
+    }
+};
+
+template <typename A>
+struct ArrayOf {
+    typedef typename A::unsupported_type_not_an_array foobar;
+};
+
+template <typename T, size_t N>
+struct ArrayOf<T[N]> {
+    static_assert(N <= 0xFF, "Arrays in protobuf messages can have at most 255 elements");
+    typedef T element_t;
+    static constexpr uint8_t capacity = N;
+};
+
+/**
+ * Message part that represents a bytes field, stored in the uint8_t array [field] with its length in [size].
+ * Longer incoming values than the array can hold are invalid.
+ */
+template <typename This, uint8_t _fieldIdx, typename A, A This::*field, uint8_t This::*size>
+struct Bytes: public WireMismatch<This>
+{
+    static_assert(std::is_same<typename ArrayOf<A>::element_t, uint8_t>::value, "Bytes should be stored in a uint8_t array");
+    static constexpr uint8_t capacity = ArrayOf<A>::capacity;
+
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+    static constexpr uint8_t initialPresence = 0;
+    static constexpr uint16_t maxLength = 1 + varint_size(uint32_t(capacity)) + capacity;
+
+    static void initialize(This *t) {
+        t->*size = 0;
+    }
+
+    template <typename fifo_t>
+    static ReadResult readNested(fifo_t &fifo, This *t, const uint32_t count) {
+        if (count > capacity) {
+            return ReadResult::Invalid;
+        }
+        if (fifo.getReadAvailable() < count) {
+            return ReadResult::Partial;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            fifo.uncheckedRead((t->*field)[i]);
+        }
+        t->*size = count;
+        return ReadResult::Valid;
+    }
+
+    static Streams::Protobuf::Bytes<_fieldIdx> forWriting(const This *t) {
+        return { t->*field, t->*size };
+    }
+
+    static uint8_t length(const This *t) {
+        return 1 + varint_size(t->*size) + t->*size;
+    }
+};
+
+/**
+ * Message part that represents a string field, stored zero-terminated in the char array [field]. Incoming strings
+ * that don't fit, including their terminator, are invalid.
+ */
+template <typename This, uint8_t _fieldIdx, typename A, A This::*field>
+struct String: public WireMismatch<This>
+{
+    static_assert(std::is_same<typename ArrayOf<A>::element_t, char>::value, "Strings should be stored in a char array");
+    static constexpr uint8_t capacity = ArrayOf<A>::capacity;
+
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+    static constexpr uint8_t initialPresence = 0;
+    static constexpr uint16_t maxLength = 1 + varint_size(uint32_t(capacity - 1)) + capacity - 1;
+
+    static void initialize(This *t) {
+        (t->*field)[0] = '\0';
+    }
+
+    template <typename fifo_t>
+    static ReadResult readNested(fifo_t &fifo, This *t, const uint32_t count) {
+        if (count >= capacity) {
+            return ReadResult::Invalid;
+        }
+        if (fifo.getReadAvailable() < count) {
+            return ReadResult::Partial;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            uint8_t c;
+            fifo.uncheckedRead(c);
+            (t->*field)[i] = c;
+        }
+        (t->*field)[count] = '\0';
+        return ReadResult::Valid;
+    }
+
+    static uint8_t size(const This *t) {
+        return strnlen(t->*field, capacity);
+    }
+
+    static Streams::Protobuf::Bytes<_fieldIdx> forWriting(const This *t) {
+        return { (const uint8_t *) (t->*field), size(t) };
+    }
+
+    static uint8_t length(const This *t) {
+        const uint8_t l = size(t);
+        return 1 + varint_size(l) + l;
+    }
+};
+
+template <typename T>
+ReadResult decodeUnsigned(uint32_t value, T &v) {
+    if (value > std::numeric_limits<T>::max()) {
+        return ReadResult::Invalid;
+    }
+    v = value;
+    return ReadResult::Valid;
+}
+
+template <typename T>
+ReadResult decodeSigned(uint32_t value, T &v) {
+    const int32_t i = unzigzag32(value);
+    if (i > std::numeric_limits<T>::max() || i < std::numeric_limits<T>::min()) {
+        return ReadResult::Invalid;
+    }
+    v = i;
+    return ReadResult::Valid;
+}
+
+inline ReadResult decodeElement(uint32_t value, uint8_t &v) { return decodeUnsigned(value, v); }
+inline ReadResult decodeElement(uint32_t value, uint16_t &v) { return decodeUnsigned(value, v); }
+inline ReadResult decodeElement(uint32_t value, uint32_t &v) { return decodeUnsigned(value, v); }
+inline ReadResult decodeElement(uint32_t value, int8_t &v) { return decodeSigned(value, v); }
+inline ReadResult decodeElement(uint32_t value, int16_t &v) { return decodeSigned(value, v); }
+inline ReadResult decodeElement(uint32_t value, int32_t &v) { return decodeSigned(value, v); }
+inline ReadResult decodeElement(uint32_t value, float &v) { v = bitsToFloat(value); return ReadResult::Valid; }
+
+/**
+ * Message part that represents a repeated scalar field, stored in the array [field] with the number of elements
+ * in [count]. Unsigned ints are varints, signed ints are zigzag varints, and floats are fixed32. It's written
+ * packed, and read either packed or as separate elements. More incoming elements than the array can hold are invalid.
+ */
+template <typename This, uint8_t _fieldIdx, typename A, A This::*field, uint8_t This::*count>
+struct Repeated: public WireMismatch<This>
+{
+    typedef typename ArrayOf<A>::element_t T;
+    typedef PackedElement<T> E;
+    static constexpr uint8_t capacity = ArrayOf<A>::capacity;
+
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+    static constexpr uint8_t initialPresence = 0;
+    static constexpr uint16_t maxPackedLength = uint16_t(capacity) * (E::fixed ? 4 : varint_max_size(sizeof(T)));
+    static constexpr uint16_t maxLength = 1 + varint_size(uint32_t(maxPackedLength)) + maxPackedLength;
+
+    static void initialize(This *t) {
+        t->*count = 0;
+    }
+
+    static ReadResult append(This *t, uint32_t value) {
+        if (t->*count >= capacity) {
+            return ReadResult::Invalid;
+        }
+        const ReadResult result = decodeElement(value, (t->*field)[t->*count]);
+        if (result == ReadResult::Valid) {
+            (t->*count)++;
+        }
+        return result;
+    }
+
+    static ReadResult assign(This *t, uint32_t value) {
+        return (E::fixed) ? ReadResult::Invalid : append(t, value);
+    }
+
+    static ReadResult assignFixed32(This *t, uint32_t value) {
+        return (E::fixed) ? append(t, value) : ReadResult::Invalid;
+    }
+
+    template <typename fifo_t>
+    static ReadResult readNested(fifo_t &fifo, This *t, const uint32_t length) {
+        if (fifo.getReadAvailable() < length) {
+            return ReadResult::Partial;
+        }
+        const uint8_t end = fifo.getReadAvailable() - length;
+        while (fifo.getReadAvailable() > end) {
+            uint32_t value;
+            const ReadResult result = (E::fixed) ? readFixed(fifo, value) : readVarint(fifo, value);
+            if (result != ReadResult::Valid || fifo.getReadAvailable() < end) {
+                return ReadResult::Invalid;
+            }
+            if (append(t, value) != ReadResult::Valid) {
+                return ReadResult::Invalid;
+            }
+        }
+        return ReadResult::Valid;
+    }
+
+    static Streams::Protobuf::Packed<T, _fieldIdx> forWriting(const This *t) {
+        return { t->*field, t->*count };
+    }
+
+    static uint8_t length(const This *t) {
+        if (t->*count == 0) {
+            return 0;
+        }
+        const uint16_t l = packed_size(t->*field, t->*count);
+        return 1 + varint_size(l) + l;
+    }
+};
+
+/**
+ * Reading behaviour for fields that aren't in a message: they're skipped, whatever their wire type.
+ */
+template <typename This>
+struct UnknownField {
+    static ReadResult assign(This *t, uint32_t value) {
+        return ReadResult::Valid;
+    }
+
+    static ReadResult assignFixed32(This *t, uint32_t value) {
+        return ReadResult::Valid;
+    }
+
+    static ReadResult assignFixed64(This *t, uint64_t value) {
+        return ReadResult::Valid;
+    }
+
+    template <typename fifo_t>
+    static ReadResult readNested(fifo_t &fifo, This *t, const uint32_t count) {
+        return skip(fifo, count);
+    }
+};
+
+/**
+ * How a message field is assigned for each of the wire types that carry a value directly.
+ */
+template <typename This>
+struct ValueHandlers {
+    ReadResult (*assign)(This *t, uint32_t value);
+    ReadResult (*assignFixed32)(This *t, uint32_t value);
+    ReadResult (*assignFixed64)(This *t, uint64_t value);
+};
+
+template <typename This, typename field>
+constexpr ValueHandlers<This> valueHandlersOf() {
+    return { &field::assign, &field::assignFixed32, &field::assignFixed64 };
+}
+
+template <typename This, typename fifo_t>
+using NestedHandler = ReadResult (*)(fifo_t &fifo, This *t, const uint32_t count);
+
+/**
+ * Handlers of a message's fields, indexed directly by field number. Numbers without a field, and the one extra
+ * entry at the end for all numbers beyond the highest field, hold the handlers of UnknownField.
+ */
+template <typename handler_t, uint8_t size>
+struct HandlerTable {
+    handler_t entries[size];
+};
+
+template <typename handler_t, uint8_t size>
+constexpr HandlerTable<handler_t, size> buildHandlerTable(const uint8_t *fieldIdx, const handler_t *handlers, uint8_t count, handler_t unknown) {
+    HandlerTable<handler_t, size> table = {};
+    bool taken[size] = {};
+    for (uint8_t i = 0; i < size; i++) {
+        table.entries[i] = unknown;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        // if a field number is declared twice, the first declaration wins
+        if (!taken[fieldIdx[i]]) {
+            table.entries[fieldIdx[i]] = handlers[i];
+            taken[fieldIdx[i]] = true;
+        }
+    }
+    return table;
+}
+
+template <typename T>
+T readFromProgmem(const T &field) {
+    T value;
+    uint8_t *dest = (uint8_t *) &value;
+    const uint8_t *src = (const uint8_t *) &field;
+    for (uint8_t i = 0; i < sizeof(T); i++) {
+        dest[i] = pgm_read_byte(src + i);
+    }
+    return value;
+}
+
 /**
  * A protocol that represents an undelimited or delimited protobuf message.
  * When reading an initial protobug message, read will continue until the end of the fifo or chunk.
@@ -357,6 +759,68 @@ struct SubMessage {
 template <typename This, typename... fields>
 class Message {
     using F = Fields<This, fields...>;
+
+    static constexpr uint8_t unknownSlot = F::maxFieldIdx + 1;
+    static constexpr uint8_t tableSize = unknownSlot + 1;
+
+    // Each list has a trailing dummy, so that they're never empty.
+    static constexpr uint8_t fieldIdxs[] = { fields::fieldIdx..., 0 };
+    static constexpr ValueHandlers<This> valueHandlers[] = { valueHandlersOf<This, fields>()..., valueHandlersOf<This, UnknownField<This>>() };
+    static constexpr HandlerTable<ValueHandlers<This>, tableSize> valueTable PROGMEM =
+        buildHandlerTable<ValueHandlers<This>, tableSize>(fieldIdxs, valueHandlers, sizeof...(fields), valueHandlersOf<This, UnknownField<This>>());
+
+    template <typename fifo_t>
+    struct NestedTable {
+        static constexpr NestedHandler<This, fifo_t> handlers[] = { &fields::template readNested<fifo_t>..., &UnknownField<This>::template readNested<fifo_t> };
+        static constexpr HandlerTable<NestedHandler<This, fifo_t>, tableSize> table PROGMEM =
+            buildHandlerTable<NestedHandler<This, fifo_t>, tableSize>(fieldIdxs, handlers, sizeof...(fields), &UnknownField<This>::template readNested<fifo_t>);
+    };
+
+    template <typename fifo_t>
+    static ReadResult readField(fifo_t &fifo, This *t, uint8_t field_and_type, typename F::presence_t &presence) {
+        const uint8_t fieldIdx = field_and_type >> 3;
+        const uint8_t slot = (fieldIdx <= F::maxFieldIdx) ? fieldIdx : unknownSlot;
+        const ValueHandlers<This> &handlers = valueTable.entries[slot];
+        ReadResult result = ReadResult::Invalid;
+        switch (field_and_type & 0x07) {
+        case VARINT: {
+            uint32_t value;
+            result = readVarint(fifo, value);
+            if (result == ReadResult::Valid) {
+                result = readFromProgmem(handlers.assign)(t, value);
+            }
+            break;
+        }
+        case LENGTH_DELIMITED: {
+            uint32_t length;
+            result = readVarint(fifo, length);
+            if (result == ReadResult::Valid) {
+                result = readFromProgmem(NestedTable<fifo_t>::table.entries[slot])(fifo, t, length);
+            }
+            break;
+        }
+        case FIXED32: {
+            uint32_t value;
+            result = readFixed(fifo, value);
+            if (result == ReadResult::Valid) {
+                result = readFromProgmem(handlers.assignFixed32)(t, value);
+            }
+            break;
+        }
+        case FIXED64: {
+            uint64_t value;
+            result = readFixed(fifo, value);
+            if (result == ReadResult::Valid) {
+                result = readFromProgmem(handlers.assignFixed64)(t, value);
+            }
+            break;
+        }
+        }
+        if (result == ReadResult::Valid && fieldIdx <= F::maxFieldIdx) {
+            presence[fieldIdx] = 0;
+        }
+        return result;
+    }
 public:
     template <typename fifo_t>
     static ReadResult read1(fifo_t &fifo, This *t) {
@@ -365,38 +829,9 @@ public:
         while (fifo.getReadAvailable() >= 2) {
             uint8_t field_and_type;
             fifo.uncheckedRead(field_and_type);
-            if ((field_and_type & 0x07) == VARINT) {
-                uint32_t value;
-                ReadResult result = readVarint(fifo, value);
-                if (result != ReadResult::Valid) {
-                    return result;
-                }
-                const uint8_t fieldIdx = field_and_type >> 3;
-                result = F::assignField(t, fieldIdx, value);
-                if (result != ReadResult::Valid) {
-                    return result;
-                } else {
-                    if (fieldIdx <= F::maxFieldIdx) {
-                        presence[fieldIdx] = 0;
-                    }
-                }
-            } else if ((field_and_type & 0x07) == LENGTH_DELIMITED) {
-                uint32_t length;
-                ReadResult result = readVarint(fifo, length);
-                if (result != ReadResult::Valid) {
-                    return result;
-                }
-                const uint8_t fieldIdx = field_and_type >> 3;
-                result = F::readNestedField(fifo, t, fieldIdx, length);
-                if (result != ReadResult::Valid) {
-                    return result;
-                } else {
-                    if (fieldIdx <= F::maxFieldIdx) {
-                        presence[fieldIdx] = 0;
-                    }
-                }
-            } else {
-                return ReadResult::Invalid;
+            const ReadResult result = readField(fifo, t, field_and_type, presence);
+            if (result != ReadResult::Valid) {
+                return result;
             }
         }
         bool complete = true;
@@ -430,42 +865,11 @@ public:
             uint8_t field_and_type;
             fifo.uncheckedRead(field_and_type);
             remaining--;
-            if ((field_and_type & 0x07) == VARINT) {
-                uint32_t value;
-                uint8_t before = fifo.getReadAvailable();
-                ReadResult result = readVarint(fifo, value);
-                remaining -= (before - fifo.getReadAvailable());
-                if (result != ReadResult::Valid) {
-                    return result;
-                }
-                const uint8_t fieldIdx = field_and_type >> 3;
-                result = F::assignField(t, fieldIdx, value);
-                if (result != ReadResult::Valid) {
-                    return result;
-                } else {
-                    if (fieldIdx <= F::maxFieldIdx) {
-                        presence[fieldIdx] = 0;
-                    }
-                }
-            } else if ((field_and_type & 0x07) == LENGTH_DELIMITED) {
-                uint32_t length;
-                uint8_t before = fifo.getReadAvailable();
-                ReadResult result = readVarint(fifo, length);
-                if (result != ReadResult::Valid) {
-                    return result;
-                }
-                const uint8_t fieldIdx = field_and_type >> 3;
-                result = F::readNestedField(fifo, t, fieldIdx, length);
-                remaining -= (before - fifo.getReadAvailable());
-                if (result != ReadResult::Valid) {
-                    return result;
-                } else {
-                    if (fieldIdx <= F::maxFieldIdx) {
-                        presence[fieldIdx] = 0;
-                    }
-                }
-            } else {
-                return ReadResult::Invalid;
+            const uint8_t before = fifo.getReadAvailable();
+            const ReadResult result = readField(fifo, t, field_and_type, presence);
+            remaining -= (before - fifo.getReadAvailable());
+            if (result != ReadResult::Valid) {
+                return result;
             }
         }
         if (remaining < 0) { // we got more bytes than the initial length indicated
@@ -485,9 +889,24 @@ public:
         }
     }
 
+    /** The maximum number of bytes the fields of this message can take up, i.e. without any tag or length */
+    static constexpr uint16_t maxContentLength = F::maxLength;
+
+    /** The maximum number of bytes this message can take up when nested in another one */
+    static constexpr uint16_t maxLength = saturatedSum(1 + varint_size(uint32_t(maxContentLength)), maxContentLength);
+
+    /**
+     * Writes all fields. If the fifo has space for the largest possible encoding of this message, that's the
+     * only space check, and all fields are written unchecked. Otherwise, each field checks on its own, since
+     * the actual encoding might still fit.
+     */
     template <typename sem, typename fifo_t>
     static bool write1(fifo_t &fifo, const This *t) {
-        return ::Streams::Impl::writeN<sem>(fifo, fields::forWriting(t)...);
+        if (maxContentLength <= 0xFF && sem::canWrite(fifo, maxContentLength)) {
+            return ::Streams::Impl::writeN<PreCheckedWriteSemantics<sem>>(fifo, fields::forWriting(t)...);
+        } else {
+            return ::Streams::Impl::writeN<sem>(fifo, fields::forWriting(t)...);
+        }
     }
 
     template <uint8_t fieldIdx>
@@ -508,6 +927,23 @@ public:
     }
 };
 
+template <typename This, typename... fields>
+constexpr uint8_t Message<This, fields...>::fieldIdxs[];
+
+template <typename This, typename... fields>
+constexpr ValueHandlers<This> Message<This, fields...>::valueHandlers[];
+
+template <typename This, typename... fields>
+constexpr HandlerTable<ValueHandlers<This>, Message<This, fields...>::tableSize> Message<This, fields...>::valueTable PROGMEM;
+
+template <typename This, typename... fields>
+template <typename fifo_t>
+constexpr NestedHandler<This, fifo_t> Message<This, fields...>::NestedTable<fifo_t>::handlers[];
+
+template <typename This, typename... fields>
+template <typename fifo_t>
+constexpr HandlerTable<NestedHandler<This, fifo_t>, Message<This, fields...>::tableSize> Message<This, fields...>::NestedTable<fifo_t>::table PROGMEM;
+
 } // namespace ProtocolImpl
 
 template <typename This>
@@ -520,6 +956,24 @@ struct Protocol {
 
     template <uint8_t _fieldIdx, typename U, U This::*field, typename protocol = typename U::DefaultProtocol>
     using SubMessage = ProtocolImpl::SubMessage<This, _fieldIdx, U, field, protocol>;
+
+    template <uint8_t _fieldIdx, typename T, T This::*field>
+    using Fixed32 = ProtocolImpl::Fixed32<This, _fieldIdx, T, field>;
+
+    template <uint8_t _fieldIdx, typename T, T This::*field>
+    using Fixed64 = ProtocolImpl::Fixed64<This, _fieldIdx, T, field>;
+
+    template <uint8_t _fieldIdx, float This::*field>
+    using Float = ProtocolImpl::Fixed32<This, _fieldIdx, float, field>;
+
+    template <uint8_t _fieldIdx, typename A, A This::*field, uint8_t This::*size>
+    using Bytes = ProtocolImpl::Bytes<This, _fieldIdx, A, field, size>;
+
+    template <uint8_t _fieldIdx, typename A, A This::*field>
+    using String = ProtocolImpl::String<This, _fieldIdx, A, field>;
+
+    template <uint8_t _fieldIdx, typename A, A This::*field, uint8_t This::*count>
+    using Repeated = ProtocolImpl::Repeated<This, _fieldIdx, A, field, count>;
 };
 
 } // namespace Protobuf
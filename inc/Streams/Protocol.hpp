@@ -187,6 +187,24 @@ struct Protocol {
         }
     };
 
+    /** Serializes a field as a decimal number with [scale] digits after the point */
+    template <typename int_t, uint8_t scale, int_t This::*field>
+    struct FixedPoint: public Single<FixedPoint<int_t, scale, field>> {
+        static ::Streams::Impl::FixedPoint<int_t*, scale> forReading(This *t) {
+            return ::Streams::FixedPoint<scale>(&(t->*field));
+        }
+
+        static ::Streams::Impl::FixedPoint<int_t, scale> forWriting(const This *t) {
+            return ::Streams::FixedPoint<scale>(t->*field);
+        }
+
+        static uint8_t length(const This *t) {
+            typedef typename std::conditional<(int_t(-1) < int_t(0)), int32_t, uint32_t>::type wide_t;
+            char text[::Streams::Impl::Format::maxFixedPointLength];
+            return ::Streams::Impl::Format::toFixedPoint(text, wide_t(t->*field), scale);
+        }
+    };
+
     /** Serializes a field as hexadecimal, with fixed length (padded with zeroes) */
     template <typename int_t, int_t This::*field>
     struct Hexadecimal: public Single<Hexadecimal<int_t, field>> {
@@ -5,6 +5,7 @@
 #include "AtomicScope.hpp"
 #include "ReadResult.hpp"
 #include "ReadingN.hpp"
+#include "ReadingResumable.hpp"
 
 namespace Streams {
 
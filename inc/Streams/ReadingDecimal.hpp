@@ -3,6 +3,7 @@
 
 #include "ReadingBase.hpp"
 #include "Format.hpp"
+#include "gcc_limits.h"
 
 namespace Streams {
 namespace Impl {
@@ -61,6 +62,82 @@ ReadResult read1(fifo_t &fifo, Decimal<uint8_t*> v) {
     return ReadResult::Valid;
 }
 
+/** Appends [digit] to [value], unless that would make it exceed [limit]. */
+template <uint32_t limit>
+inline bool appendDigit(uint32_t &value, uint8_t digit) {
+    if (value > limit / 10 || (value == limit / 10 && digit > limit % 10)) {
+        return false;
+    }
+    value = value * 10 + digit;
+    return true;
+}
+
+/**
+ * Reads a decimal number like "23.5" or "-0.25" into an integer scaled by 10^scale, i.e. 235 or -250 for [scale]
+ * 2. The point and the digits after it are optional, and any digits beyond [scale] are dropped.
+ */
+template <typename fifo_t, typename int_t, uint8_t scale>
+ReadResult read1(fifo_t &fifo, FixedPoint<int_t*, scale> v) {
+    static_assert(sizeof(int_t) <= 4, "Fixed point numbers can have at most 32 bits");
+    constexpr bool isSigned = int_t(-1) < int_t(0);
+    constexpr uint32_t maxPositive = uint32_t(std::numeric_limits<int_t>::max());
+    constexpr uint32_t maxNegative = isSigned ? maxPositive + 1 : 0;
+
+    uint8_t available = fifo.getReadAvailable();
+    if (available < 1) {
+        return ReadResult::Incomplete;
+    }
+
+    bool negative = false;
+    if (isSigned && fifo.peek() == '-') {
+        uint8_t sign;
+        fifo.uncheckedRead(sign);
+        available--;
+        negative = true;
+        if (available < 1) {
+            return ReadResult::Incomplete;
+        }
+    }
+    if (!isDigit(fifo.peek())) {
+        return ReadResult::Invalid;
+    }
+
+    auto append = [&negative] (uint32_t &value, uint8_t digit) {
+        return negative ? appendDigit<maxNegative>(value, digit) : appendDigit<maxPositive>(value, digit);
+    };
+
+    uint32_t value = 0;
+    uint8_t decimals = 0;
+    bool point = false;
+    for (; available > 0; available--) {
+        const uint8_t ch = fifo.peek();
+        if (isDigit(ch)) {
+            if (!point || decimals < scale) {
+                if (!append(value, ch - '0')) {
+                    return ReadResult::Invalid;
+                }
+                if (point) {
+                    decimals++;
+                }
+            }
+        } else if (ch == '.' && !point) {
+            point = true;
+        } else {
+            break;
+        }
+        uint8_t skip;
+        fifo.uncheckedRead(skip);
+    }
+    for (; decimals < scale; decimals++) {
+        if (!append(value, 0)) {
+            return ReadResult::Invalid;
+        }
+    }
+
+    *(v.value) = negative ? int_t(uint32_t(0) - value) : int_t(value);
+    return ReadResult::Valid;
+}
+
 }
 }
 
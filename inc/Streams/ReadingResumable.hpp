@@ -0,0 +1,100 @@
+#ifndef STREAMS_READINGRESUMABLE_HPP_
+#define STREAMS_READINGRESUMABLE_HPP_
+
+#include "ReadingN.hpp"
+#include "AtomicScope.hpp"
+
+namespace Streams {
+
+class ReadProgress;
+
+namespace Impl {
+
+template <typename fifo_t, typename head_t, typename... tail_t>
+ReadResult resumeN(fifo_t &fifo, ReadProgress &progress, uint8_t index, head_t head, tail_t... tail);
+
+}
+
+/**
+ * Remembers how many elements of a read() have already been consumed, so that a read that came back Incomplete
+ * or Partial continues with the element it stopped at once more data has arrived, rather than parsing everything
+ * from the start again. Pass a pointer to it as the first argument:
+ *
+ *     ReadResult r = fifo.read(&progress, F("+IPD,"), Decimal(&length), F(":"), ChunkWithLength(&length, target));
+ *
+ * Elements that were read are removed from the fifo right away, so the targets of the read must outlive the
+ * ReadProgress (e.g. be members rather than local variables). Any Valid or Invalid result starts over at the first
+ * element. Only works on a plain fifo, not on a ChunkedFifo, since the latter can't commit part of a chunk.
+ */
+class ReadProgress {
+    uint8_t done = 0;
+
+    template <typename fifo_t, typename head_t, typename... tail_t>
+    friend ReadResult Impl::resumeN(fifo_t &fifo, ReadProgress &progress, uint8_t index, head_t head, tail_t... tail);
+
+public:
+    /** Returns the number of elements that have been read so far. */
+    uint8_t getDone() const {
+        return done;
+    }
+
+    /** Makes the next read start from the first element again. */
+    void reset() {
+        done = 0;
+    }
+};
+
+namespace Impl {
+
+template <typename fifo_t>
+ReadResult resumeN(fifo_t &fifo, ReadProgress &progress, uint8_t index) {
+    return ReadResult::Valid;
+}
+
+template <typename fifo_t, typename head_t, typename... tail_t>
+ReadResult resumeN(fifo_t &fifo, ReadProgress &progress, uint8_t index, head_t head, tail_t... tail) {
+    if (index >= progress.done) {
+        const ReadResult result = ReadN<void, head_t>::apply(fifo, ReadResult::Valid, head);
+        if (result != ReadResult::Valid) {
+            return result;
+        }
+        if (sizeof...(tail_t) > 0) {
+            if (fifo.getReadAvailable() == 0) {
+                // An element that ends exactly where the data does might not be complete yet, e.g. a Decimal
+                // that only got its first digit, so it's only committed once something follows it.
+                return ReadResult::Incomplete;
+            }
+            fifo.readEnd();
+            fifo.readStart();
+            progress.done++;
+        }
+    }
+    return resumeN(fifo, progress, index + 1, tail...);
+}
+
+template <typename fifo_t, typename... types>
+ReadResult read(fifo_t &fifo, ReadProgress *progress, types... args) {
+    AtomicScope _;
+
+    if (fifo.isReading()) {
+        // Nested inside an enclosing read, which can only be committed as a whole.
+        return readN(fifo, ReadResult::Valid, args...);
+    }
+
+    fifo.readStart();
+    const ReadResult result = resumeN(fifo, *progress, 0, args...);
+    if (result == ReadResult::Valid) {
+        fifo.readEnd();
+    } else {
+        fifo.readAbort();
+    }
+    if (result == ReadResult::Valid || result == ReadResult::Invalid) {
+        progress->reset();
+    }
+    return result;
+}
+
+} // namespace Impl
+} // namespace Streams
+
+#endif /* STREAMS_READINGRESUMABLE_HPP_ */
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "Strings.hpp"
+#include "Logging.hpp"
+#include "gcc_type_traits.h"
+#include <stdint.h>
+
+namespace Streams {
+
+namespace Impl {
+
+/**
+ * Aho-Corasick automaton over a set of tokens: a trie of all tokens, in which each state also has a failure link
+ * to the state of its longest proper suffix that's also in the trie. State 0 is the root.
+ */
+template <uint8_t states>
+struct TokenAutomaton {
+    /** Character on the edge from a state's parent into that state */
+    uint8_t ch[states];
+    /** First child of a state, or 0 if it has none */
+    uint8_t firstChild[states];
+    /** Next child of the same parent, or 0 if this was the last one */
+    uint8_t nextSibling[states];
+    /** State to continue from if the next character doesn't extend the current one */
+    uint8_t fail[states];
+    /** 1-based index of the token that is complete when reaching this state, or 0 if none is */
+    uint8_t match[states];
+};
+
+template <uint8_t states>
+constexpr uint8_t childInTrie(const TokenAutomaton<states> &a, uint8_t state, uint8_t c) {
+    for (uint8_t child = a.firstChild[state]; child != 0; child = a.nextSibling[child]) {
+        if (a.ch[child] == c) {
+            return child;
+        }
+    }
+    return 0;
+}
+
+template <uint8_t states>
+constexpr TokenAutomaton<states> buildTokenAutomaton(const char * const *tokens, const uint8_t *lengths, uint8_t count) {
+    TokenAutomaton<states> a = {};
+
+    uint8_t used = 1;
+    for (uint8_t t = 0; t < count; t++) {
+        uint8_t state = 0;
+        for (uint8_t i = 0; i < lengths[t]; i++) {
+            const uint8_t c = tokens[t][i];
+            uint8_t child = childInTrie(a, state, c);
+            if (child == 0) {
+                child = used++;
+                a.ch[child] = c;
+                a.nextSibling[child] = a.firstChild[state];
+                a.firstChild[state] = child;
+            }
+            state = child;
+        }
+        if (a.match[state] == 0) {
+            a.match[state] = t + 1;
+        }
+    }
+
+    // Failure links are assigned breadth-first, since they always point to a shallower state.
+    uint8_t queue[states] = {};
+    uint8_t head = 0, tail = 0;
+    for (uint8_t child = a.firstChild[0]; child != 0; child = a.nextSibling[child]) {
+        queue[tail++] = child;
+    }
+    while (head < tail) {
+        const uint8_t state = queue[head++];
+        for (uint8_t child = a.firstChild[state]; child != 0; child = a.nextSibling[child]) {
+            uint8_t f = a.fail[state];
+            while (f != 0 && childInTrie(a, f, a.ch[child]) == 0) {
+                f = a.fail[f];
+            }
+            a.fail[child] = childInTrie(a, f, a.ch[child]);
+            if (a.match[child] == 0) {
+                a.match[child] = a.match[a.fail[child]];
+            }
+            queue[tail++] = child;
+        }
+    }
+    return a;
+}
+
+constexpr uint16_t sumOf() {
+    return 0;
+}
+
+template <typename... rest_t>
+constexpr uint16_t sumOf(uint16_t head, rest_t... rest) {
+    return head + sumOf(rest...);
+}
+
+template <typename token_t, typename... tokens_t>
+struct TokenIndex {
+    static constexpr uint8_t value = 0;
+};
+
+template <typename token_t, typename head_t, typename... tail_t>
+struct TokenIndex<token_t, head_t, tail_t...> {
+    static constexpr uint8_t value = std::is_same<token_t, head_t>::value ? 1 :
+                                     (TokenIndex<token_t, tail_t...>::value == 0) ? 0 :
+                                     TokenIndex<token_t, tail_t...>::value + 1;
+};
+
+/**
+ * Finds the first complete occurrence of any of [tokens_t] (STR() strings) in a stream, while reading every byte
+ * only once. The tokens are compiled into an Aho-Corasick automaton, which lives in flash. Only the current state
+ * is kept in RAM, so a token that is split over several arrivals of data is picked up where it was left.
+ */
+template <typename... tokens_t>
+class TokenMatcher {
+    typedef Logging::Log<Loggers::Scanner> log;
+    static constexpr uint16_t totalLength = sumOf(tokens_t::size()...);
+    static_assert(totalLength < 255, "Tokens are too long to fit an 8-bit state");
+
+    static constexpr uint8_t states = totalLength + 1;
+    static constexpr const char *tokens[] = { tokens_t::data()... };
+    static constexpr uint8_t lengths[] = { uint8_t(tokens_t::size())... };
+
+    static constexpr TokenAutomaton<states> automaton PROGMEM = buildTokenAutomaton<states>(tokens, lengths, sizeof...(tokens_t));
+
+    uint8_t state = 0;
+    uint8_t pending = 0;
+
+    static uint8_t read(const uint8_t &field) {
+        return pgm_read_byte(&field);
+    }
+
+    static uint8_t next(uint8_t s, uint8_t c) {
+        while (true) {
+            for (uint8_t child = read(automaton.firstChild[s]); child != 0; child = read(automaton.nextSibling[child])) {
+                if (read(automaton.ch[child]) == c) {
+                    return child;
+                }
+            }
+            if (s == 0) {
+                return 0;
+            }
+            s = read(automaton.fail[s]);
+        }
+    }
+
+public:
+    /** Returns the value scan() returns when it has found [token_t]. */
+    template <typename token_t>
+    static constexpr uint8_t id() {
+        static_assert(TokenIndex<token_t, tokens_t...>::value != 0, "token_t is not one of this matcher's tokens");
+        return TokenIndex<token_t, tokens_t...>::value;
+    }
+
+    /**
+     * Consumes bytes from [fifo] until any of the tokens is complete, returning its id(), or 0 if the fifo ran out
+     * before that. Anything that isn't part of a token is skipped.
+     */
+    template <typename fifo_t>
+    uint8_t scan(fifo_t &fifo) {
+        if (pending != 0) {
+            const uint8_t token = pending;
+            pending = 0;
+            return token;
+        }
+        for (uint8_t available = fifo.getReadAvailable(); available > 0; available--) {
+            uint8_t c;
+            fifo.uncheckedRead(c);
+            state = next(state, c);
+            const uint8_t token = read(automaton.match[state]);
+            if (token != 0) {
+                log::debug(F("tok "), dec(token));
+                state = 0;
+                return token;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * Makes the next scan() return [token] again without consuming anything, e.g. because the data that should
+     * follow the token hasn't completely arrived yet.
+     */
+    void unread(uint8_t token) {
+        pending = token;
+    }
+
+    /** Forgets any partially matched token. */
+    void reset() {
+        state = 0;
+        pending = 0;
+    }
+};
+
+template <typename... tokens_t>
+constexpr const char *TokenMatcher<tokens_t...>::tokens[];
+
+template <typename... tokens_t>
+constexpr uint8_t TokenMatcher<tokens_t...>::lengths[];
+
+template <typename... tokens_t>
+constexpr TokenAutomaton<TokenMatcher<tokens_t...>::states> TokenMatcher<tokens_t...>::automaton PROGMEM;
+
+}
+
+/**
+ * Declares a TokenMatcher for the given STR() tokens, e.g.
+ *
+ *     TokenMatcher<STR("OK\r\n"), STR("ERROR\r\n")> replies;
+ *     switch (replies.scan(fifo)) {
+ *         case decltype(replies)::id<STR("OK\r\n")>(): ...
+ *     }
+ */
+template <typename... tokens_t>
+using TokenMatcher = Impl::TokenMatcher<tokens_t...>;
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <string.h>
 
 namespace Streams {
 namespace Protobuf {
@@ -24,16 +25,70 @@ public:
     constexpr operator int_t() const { return value; }
 };
 
+/**
+ * A 32-bit value written as fixed32 wire type, i.e. 4 little-endian bytes. Floats are written by their bits.
+ */
+template <uint8_t _fieldIdx>
+class Fixed32 {
+    static_assert(_fieldIdx < (0xFF >> 3), "field numbers must fit in 5 bits");
+    uint32_t value;
+public:
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+
+    constexpr Fixed32(uint32_t v): value(v) {}
+    constexpr operator uint32_t() const { return value; }
+};
+
+/**
+ * A 64-bit value written as fixed64 wire type, i.e. 8 little-endian bytes.
+ */
+template <uint8_t _fieldIdx>
+class Fixed64 {
+    static_assert(_fieldIdx < (0xFF >> 3), "field numbers must fit in 5 bits");
+    uint64_t value;
+public:
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+
+    constexpr Fixed64(uint64_t v): value(v) {}
+    constexpr operator uint64_t() const { return value; }
+};
+
+/**
+ * [length] raw bytes, written as a length-delimited bytes or string field.
+ */
+template <uint8_t _fieldIdx>
+struct Bytes {
+    static_assert(_fieldIdx < (0xFF >> 3), "field numbers must fit in 5 bits");
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+
+    const uint8_t *data;
+    uint8_t length;
+};
+
+/**
+ * [count] scalars, written as one length-delimited field of packed elements.
+ */
+template <typename T, uint8_t _fieldIdx>
+struct Packed {
+    static_assert(_fieldIdx < (0xFF >> 3), "field numbers must fit in 5 bits");
+    static constexpr uint8_t fieldIdx = _fieldIdx;
+
+    const T *data;
+    uint8_t count;
+};
+
 }
 
 namespace Impl {
 
 enum WireTypes: uint8_t {
     VARINT = 0,
-    LENGTH_DELIMITED = 2
+    FIXED64 = 1,
+    LENGTH_DELIMITED = 2,
+    FIXED32 = 5
 };
 
-inline uint8_t
+constexpr uint8_t
 varint_size(uint32_t v)
 {
     if (v < (1UL << 7)) {
@@ -71,6 +126,11 @@ varint_size(uint8_t v)
     }
 }
 
+/** Returns the maximum number of bytes a varint of an integer of [bytes] bytes can take. */
+constexpr uint8_t varint_max_size(uint8_t bytes) {
+    return (bytes * 8 + 6) / 7;
+}
+
 inline uint32_t
 zigzag(int32_t v)
 {
@@ -98,6 +158,64 @@ zigzag(int8_t v)
         return (uint8_t)(v) * 2;
 }
 
+inline uint32_t floatBits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
 }
+
+inline float bitsToFloat(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/**
+ * How a single element of a packed repeated field is encoded: unsigned ints as varint, signed ints as
+ * zigzag varint, and floats as fixed32.
+ */
+template <typename T>
+struct PackedElement {
+    typedef typename T::unsupported_type_for_packed_encoding foobar;
+};
+
+template <typename T>
+struct UnsignedPackedElement {
+    static constexpr bool fixed = false;
+    static uint32_t encode(T v) { return v; }
+};
+
+template <typename T>
+struct SignedPackedElement {
+    static constexpr bool fixed = false;
+    static uint32_t encode(T v) { return zigzag(int32_t(v)); }
+};
+
+template <> struct PackedElement<uint8_t>: public UnsignedPackedElement<uint8_t> {};
+template <> struct PackedElement<uint16_t>: public UnsignedPackedElement<uint16_t> {};
+template <> struct PackedElement<uint32_t>: public UnsignedPackedElement<uint32_t> {};
+template <> struct PackedElement<int8_t>: public SignedPackedElement<int8_t> {};
+template <> struct PackedElement<int16_t>: public SignedPackedElement<int16_t> {};
+template <> struct PackedElement<int32_t>: public SignedPackedElement<int32_t> {};
+
+template <>
+struct PackedElement<float> {
+    static constexpr bool fixed = true;
+    static uint32_t encode(float v) { return floatBits(v); }
+};
+
+/** Returns the number of bytes [count] elements of [data] take up when packed. */
+template <typename T>
+uint16_t packed_size(const T *data, uint8_t count) {
+    if (PackedElement<T>::fixed) {
+        return uint16_t(count) * 4;
+    }
+    uint16_t size = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        size += varint_size(PackedElement<T>::encode(data[i]));
+    }
+    return size;
 }
 
+}
+}
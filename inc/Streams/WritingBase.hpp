@@ -1,9 +1,43 @@
 #ifndef STREAMS_WRITINGBASE_HPP_
 #define STREAMS_WRITINGBASE_HPP_
 
+#include <stdint.h>
+
 namespace Streams {
 namespace Impl {
 
+/**
+ * Write semantics for data of which the maximum size has already been checked against the fifo's space, so each
+ * individual canWrite() is a compile-time true and all writes go straight through to [sem].
+ */
+template <typename sem>
+struct PreCheckedWriteSemantics {
+    template <typename fifo_t>
+    static inline bool isWriting(fifo_t &fifo) {
+        return sem::isWriting(fifo);
+    }
+
+    template <typename fifo_t>
+    static inline constexpr bool canWrite(fifo_t &fifo, uint8_t size) {
+        return true;
+    }
+
+    template <typename fifo_t>
+    static inline void write(fifo_t &fifo, uint8_t value) {
+        sem::write(fifo, value);
+    }
+
+    template <typename fifo_t>
+    static inline void start(fifo_t &fifo) {
+        sem::start(fifo);
+    }
+
+    template <typename fifo_t>
+    static inline void end(fifo_t &fifo, bool valid) {
+        sem::end(fifo, valid);
+    }
+};
+
 }}
 
 #endif /* STREAMS_WRITINGBASE_HPP_ */
@@ -5,6 +5,7 @@
 #include "Format.hpp"
 #include "EEPROM.hpp"
 #include "Option.hpp"
+#include "gcc_type_traits.h"
 
 namespace Streams {
 namespace Impl {
@@ -26,6 +27,34 @@ bool write1decimalInt(fifo_t &fifo, const Decimal<int_t> value) {
     return Format::format(&(writeFunc<sem,fifo_t>), &fifo, value);
 }
 
+template <typename sem, typename fifo_t>
+bool write1text(fifo_t &fifo, const char *text, uint8_t length) {
+    if (!sem::canWrite(fifo, length)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        sem::write(fifo, text[i]);
+    }
+    return true;
+}
+
+/** 32-bit values are formatted into a buffer first, so they only need a single check for space. */
+template <typename sem, typename fifo_t, typename int_t>
+bool write1decimalBuffered(fifo_t &fifo, const int_t value) {
+    char digits[Format::maxDecimalLength];
+    return write1text<sem>(fifo, digits, Format::toDecimal(digits, value));
+}
+
+template <typename sem, typename fifo_t>
+bool write1decimalInt(fifo_t &fifo, const Decimal<uint32_t> value) {
+    return write1decimalBuffered<sem>(fifo, value.value);
+}
+
+template <typename sem, typename fifo_t>
+bool write1decimalInt(fifo_t &fifo, const Decimal<int32_t> value) {
+    return write1decimalBuffered<sem>(fifo, value.value);
+}
+
 template <typename sem, typename fifo_t>
 bool write1(fifo_t &fifo, const Decimal<uint8_t> value) {
     return write1decimalInt<sem>(fifo, value);
@@ -66,6 +95,14 @@ bool write1(fifo_t &fifo, const Decimal<int32_t> value) {
     return write1decimalInt<sem>(fifo, value);
 }
 
+template <typename sem, typename fifo_t, typename int_t, uint8_t scale>
+bool write1(fifo_t &fifo, const FixedPoint<int_t, scale> v) {
+    static_assert(sizeof(int_t) <= 4, "Fixed point numbers can have at most 32 bits");
+    typedef typename std::conditional<(int_t(-1) < int_t(0)), int32_t, uint32_t>::type wide_t;
+    char text[Format::maxFixedPointLength];
+    return write1text<sem>(fifo, text, Format::toFixedPoint(text, wide_t(v.value), scale));
+}
+
 template <typename sem, typename fifo_t, typename read_delegate_t>
 bool write1(fifo_t &fifo, const Decimal<read_delegate_t*> d) {
     if (d.value->isReading()) {
@@ -115,7 +152,7 @@ bool write1(fifo_t &fifo, const Decimal<uint16_t EEPROM::*> field) {
 
 template <typename sem, typename fifo_t>
 bool write1(fifo_t &fifo, const Decimal<uint32_t EEPROM::*> field) {
-    Format::format(&(writeFunc<sem,fifo_t>), &fifo, dec(read(field.value)));
+    write1decimalInt<sem>(fifo, dec(read(field.value)));
     return true;
 }
 
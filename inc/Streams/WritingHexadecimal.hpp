@@ -22,6 +22,30 @@ bool write1(fifo_t &fifo, const Hexadecimal<uint8_t> value) {
     }
 }
 
+/** Writes all 4 or 8 hexadecimal digits of [value], after a single check for space. */
+template <typename sem, typename fifo_t, typename int_t>
+bool write1hexadecimalInt(fifo_t &fifo, const int_t value) {
+    constexpr uint8_t count = 2 * sizeof(int_t);
+    if (sem::canWrite(fifo, count)) {
+        for (int8_t shift = 4 * (count - 1); shift >= 0; shift -= 4) {
+            sem::write(fifo, hexChar((value >> shift) & 0x0F));
+        }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+template <typename sem, typename fifo_t>
+bool write1(fifo_t &fifo, const Hexadecimal<uint16_t> value) {
+    return write1hexadecimalInt<sem>(fifo, value.value);
+}
+
+template <typename sem, typename fifo_t>
+bool write1(fifo_t &fifo, const Hexadecimal<uint32_t> value) {
+    return write1hexadecimalInt<sem>(fifo, value.value);
+}
+
 }
 }
 
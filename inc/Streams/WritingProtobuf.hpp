@@ -126,5 +126,95 @@ bool write1(fifo_t &fifo, const Varint<int8_t, field> v) {
 	return write1<sem>(fifo, Varint<uint8_t,field>(zigzag(v)));
 }
 
+template <typename sem, typename fifo_t>
+void writeVarintBytes(fifo_t &fifo, uint32_t value) {
+	while (value >= 0x80) {
+		sem::write(fifo, value | 0x80);
+		value >>= 7;
+	}
+	sem::write(fifo, value);
+}
+
+template <typename sem, typename fifo_t, typename T>
+void writeFixedBytes(fifo_t &fifo, T value) {
+	for (uint8_t i = 0; i < sizeof(T); i++) {
+		sem::write(fifo, uint8_t(value));
+		value >>= 8;
+	}
+}
+
+/**
+ * Writes a 32-bit value as 4 little-endian bytes, with the given field index.
+ */
+template <typename sem, typename fifo_t, uint8_t field>
+bool write1(fifo_t &fifo, const Fixed32<field> v) {
+	if (sem::canWrite(fifo, 5)) {
+		sem::write(fifo, field << 3 | FIXED32);
+		writeFixedBytes<sem>(fifo, uint32_t(v));
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Writes a 64-bit value as 8 little-endian bytes, with the given field index.
+ */
+template <typename sem, typename fifo_t, uint8_t field>
+bool write1(fifo_t &fifo, const Fixed64<field> v) {
+	if (sem::canWrite(fifo, 9)) {
+		sem::write(fifo, field << 3 | FIXED64);
+		writeFixedBytes<sem>(fifo, uint64_t(v));
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Writes raw bytes, prefixed by their length, with the given field index.
+ */
+template <typename sem, typename fifo_t, uint8_t field>
+bool write1(fifo_t &fifo, const Bytes<field> v) {
+	const uint16_t size = 1 + varint_size(v.length) + v.length;
+	if (size <= 0xFF && sem::canWrite(fifo, size)) {
+		sem::write(fifo, field << 3 | LENGTH_DELIMITED);
+		writeVarintBytes<sem>(fifo, v.length);
+		for (uint8_t i = 0; i < v.length; i++) {
+			sem::write(fifo, v.data[i]);
+		}
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Writes all elements as one packed repeated field with the given field index, or nothing at all if there are none.
+ */
+template <typename sem, typename fifo_t, typename T, uint8_t field>
+bool write1(fifo_t &fifo, const Packed<T, field> v) {
+	if (v.count == 0) {
+		return true;
+	}
+	const uint16_t length = packed_size(v.data, v.count);
+	const uint16_t size = 1 + varint_size(length) + length;
+	if (size <= 0xFF && sem::canWrite(fifo, size)) {
+		sem::write(fifo, field << 3 | LENGTH_DELIMITED);
+		writeVarintBytes<sem>(fifo, length);
+		for (uint8_t i = 0; i < v.count; i++) {
+			const uint32_t e = PackedElement<T>::encode(v.data[i]);
+			if (PackedElement<T>::fixed) {
+				writeFixedBytes<sem>(fifo, e);
+			} else {
+				writeVarintBytes<sem>(fifo, e);
+			}
+		}
+		return true;
+	} else {
+		return false;
+	}
+}
+
 }
 }
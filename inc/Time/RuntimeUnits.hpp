@@ -64,6 +64,9 @@ public:
     template <typename prescaled_t>
     constexpr Counts toCounts() const { return *this; }
 
+    template <typename prescaled_t>
+    constexpr Counts toCountsOn() const { return *this; }
+
     template <typename prescaled_t>
     constexpr Milliseconds toMillisOn() const;
 
@@ -1,4 +1,5 @@
 #include "HAL/Atmel/ADConverter.hpp"
+#include "HAL/Atmel/Power.hpp"
 #include "AtomicScope.hpp"
 
 using namespace HAL::Atmel;
@@ -13,6 +14,16 @@ void Impl::BaseADC::enable() {
 	ADEN.set(); // Enable ADC
 }
 
+void Impl::BaseADC::awaitConversion() {
+    while (ADSC.isSet()) {
+        if (SREG_I.isSet()) {
+            // If the conversion happens to complete right before sleeping, entering ADC noise reduction
+            // starts another one, which will wake us up again.
+            Impl::sleep(SleepMode::ADC);
+        }
+    }
+}
+
 void Impl::BaseADC::setReference(ADReference ref) {
     switch (ref) {
     case ADReference::AREF:
@@ -26,6 +26,17 @@ void AbstractChunkedFifo::uncheckedWrite (uint8_t b) {
     (*writeLengthPtr)++;
 }
 
+bool AbstractChunkedFifo::reserve(volatile uint8_t * &ptr) {
+    AtomicScope _;
+
+    if (isWriting() && writeValid && data->reserve(ptr)) {
+        (*writeLengthPtr)++;
+        return true;
+    } else {
+        return false;
+    }
+}
+
 void AbstractChunkedFifo::writeEnd() {
     AtomicScope _;
 
@@ -78,9 +78,19 @@ bool Format::format(write_f write, void *ctx, Impl::Decimal<int16_t> v) {
     }
 }
 
-bool Format::format(write_f write, void *ctx, Impl::Decimal<uint32_t> v) {
-    const uint32_t n = v.value;
+namespace {
+
+/** Returns [x] / 10 and leaves [x] % 10 in [x], for [x] < 640, with a 16-bit multiplication instead of a division. */
+inline uint8_t divmod10(uint16_t &x) {
+    const uint8_t q = (uint16_t(x >> 1) * 205) >> 10;
+    x -= q * 10;
+    return q;
+}
 
+}
+
+uint8_t Format::toDecimal(char *out, uint32_t n) {
+    // Each digit is a weighted sum of the 4-bit groups of n, none of which exceed 449 before carrying.
     const uint8_t n0 = n & 0x1F;
     const uint8_t n1 = (n >> 5) & 0xF;
     const uint8_t n2 = (n >> 9) & 0xF;
@@ -90,89 +100,104 @@ bool Format::format(write_f write, void *ctx, Impl::Decimal<uint32_t> v) {
     const uint8_t n6 = (n >> 25) & 0xF;
     const uint8_t n7 = (n >> 29) & 0x7;
 
+    uint8_t digits[maxDecimalDigits];
+    uint16_t d;
     uint8_t q;
 
-    uint8_t d0 = 2 * (n7 + n6 + n5 + n4 + n3 + n2 + n1) + n0;
-    q = d0 / 10;
-    d0 = d0 % 10;
+    d = 2 * (n7 + n6 + n5 + n4 + n3 + n2 + n1) + n0;
+    q = divmod10(d);
+    digits[0] = d;
 
-    uint16_t d1 = q + n7 + 5 * n5 + 3 * (n6 + n1) + 7 * n4 + 9 * n3 + n2;
-    q = d1 / 10;
-    d1 = d1 % 10;
+    d = q + n7 + 5 * n5 + 3 * (n6 + n1) + 7 * n4 + 9 * n3 + n2;
+    q = divmod10(d);
+    digits[1] = d;
 
-    uint16_t d2 = q + 9 * n7 + 4 * n6 + n5 + n3 + 5 * n2;
-    q = d2 / 10;
-    d2 = d2 % 10;
+    d = q + 9 * n7 + 4 * n6 + n5 + n3 + 5 * n2;
+    q = divmod10(d);
+    digits[2] = d;
 
-    uint16_t d3 = q + 4 * n6 + 7 * n5 + n4 + 8 * n3;
-    q = d3 / 10;
-    d3 = d3 % 10;
+    d = q + 4 * n6 + 7 * n5 + n4 + 8 * n3;
+    q = divmod10(d);
+    digits[3] = d;
 
-    uint16_t d4 = q + 7 * n7 + 3 * n4 + 5 * n6 + 9 * n5;
-    q = d4 / 10;
-    d4 = d4 % 10;
+    d = q + 7 * n7 + 3 * n4 + 5 * n6 + 9 * n5;
+    q = divmod10(d);
+    digits[4] = d;
 
-    uint8_t d5 = q + 8 * n7 + 5 * n6 + n4;
-    q = d5 / 10;
-    d5 = d5 % 10;
+    d = q + 8 * n7 + 5 * n6 + n4;
+    q = divmod10(d);
+    digits[5] = d;
 
-    uint8_t d6 = q + 6 * n7 + 3 * n6 + 2 * n5;
-    q = d6 / 10;
-    d6 = d6 % 10;
+    d = q + 6 * n7 + 3 * n6 + 2 * n5;
+    q = divmod10(d);
+    digits[6] = d;
 
-    uint8_t d7 = q + 3 * n7 + 3 * n6;
-    q = d7 / 10;
-    d7 = d7 % 10;
+    d = q + 3 * n7 + 3 * n6;
+    q = divmod10(d);
+    digits[7] = d;
 
-    uint8_t d8 = q + 5 * n7;
-    q = d8 / 10;
-    d8 = d8 % 10;
+    d = q + 5 * n7;
+    q = divmod10(d);
+    digits[8] = d;
+    digits[9] = q;
 
-    bool started = false;
-    if (q != 0) {
-        if (!write (ctx, q + '0')) return false;
-        started = true;
+    uint8_t length = maxDecimalDigits;
+    while (length > 1 && digits[length - 1] == 0) {
+        length--;
     }
-    if (started || d8 != 0) {
-        if (!write (ctx, d8 + '0')) return false;
-        started = true;
+    for (uint8_t i = 0; i < length; i++) {
+        out[i] = '0' + digits[length - 1 - i];
     }
-    if (started || d7 != 0) {
-        if (!write (ctx, d7 + '0')) return false;
-        started = true;
-    }
-    if (started || d6 != 0) {
-        if (!write (ctx, d6 + '0')) return false;
-        started = true;
-    }
-    if (started || d5 != 0) {
-        if (!write (ctx, d5 + '0')) return false;
-        started = true;
-    }
-    if (started || d4 != 0) {
-        if (!write (ctx, d4 + '0')) return false;
-        started = true;
+    return length;
+}
+
+uint8_t Format::toDecimal(char *out, int32_t n) {
+    if (n < 0) {
+        out[0] = '-';
+        return 1 + toDecimal(out + 1, uint32_t(0) - uint32_t(n));
+    } else {
+        return toDecimal(out, uint32_t(n));
     }
-    if (started || d3 != 0) {
-        if (!write (ctx, d3 + '0')) return false;
-        started = true;
+}
+
+uint8_t Format::toFixedPoint(char *out, uint32_t n, uint8_t scale) {
+    char digits[maxDecimalDigits];
+    const uint8_t length = toDecimal(digits, n);
+    const uint8_t padded = (length > scale) ? length : scale + 1;
+    const uint8_t zeroes = padded - length;
+    uint8_t pos = 0;
+    for (uint8_t i = 0; i < padded; i++) {
+        if (i == padded - scale) {
+            out[pos++] = '.';
+        }
+        out[pos++] = (i < zeroes) ? '0' : digits[i - zeroes];
     }
-    if (started || d2 != 0) {
-        if (!write (ctx, d2 + '0')) return false;
-        started = true;
+    return pos;
+}
+
+uint8_t Format::toFixedPoint(char *out, int32_t n, uint8_t scale) {
+    if (n < 0) {
+        out[0] = '-';
+        return 1 + toFixedPoint(out + 1, uint32_t(0) - uint32_t(n), scale);
+    } else {
+        return toFixedPoint(out, uint32_t(n), scale);
     }
-    if (started || d1 != 0) {
-        if (!write (ctx, d1 + '0')) return false;
-        started = true;
+}
+
+bool Format::format(write_f write, void *ctx, Impl::Decimal<uint32_t> v) {
+    char out[maxDecimalLength];
+    const uint8_t length = toDecimal(out, v.value);
+    for (uint8_t i = 0; i < length; i++) {
+        if (!write(ctx, out[i])) return false;
     }
-    return write(ctx, d0 + '0');
+    return true;
 }
 
 bool Format::format(write_f write, void *ctx, Impl::Decimal<int32_t> v) {
-    if (v.value < 0) {
-        if (!write(ctx, '-')) return false;
-        return format(write, ctx, dec(uint32_t(-v.value)));
-    } else {
-        return format(write, ctx, dec(uint32_t(v.value)));
+    char out[maxDecimalLength];
+    const uint8_t length = toDecimal(out, v.value);
+    for (uint8_t i = 0; i < length; i++) {
+        if (!write(ctx, out[i])) return false;
     }
+    return true;
 }
@@ -0,0 +1,157 @@
+#ifndef AVR
+
+#include "HostLogSink.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace Logging {
+namespace Impl {
+
+void LineBuffer::start(const char *loggerName) {
+    constexpr uint16_t maxPrefix = capacity - maxMessage - 1;
+    const int prefix = snprintf(text, maxPrefix + 1, "[%9s ] ", loggerName);
+    length = (prefix < 0) ? 0 : (prefix > maxPrefix) ? maxPrefix : prefix;
+    messageStart = length;
+    writing = false;
+}
+
+void LineBuffer::finish() {
+    text[length++] = '\n';
+}
+
+namespace {
+
+/**
+ * Bounded multi-producer ring of lines, in which each slot's sequence number tells whose turn it is: a producer
+ * may fill the slot for position p once the sequence is p, and the flusher may take it once it's p + 1.
+ */
+class Sink {
+    static constexpr uint32_t slotCount = 1024;
+    static constexpr uint32_t batchSize = 64 * LineBuffer::capacity;
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        uint16_t length;
+        char text[LineBuffer::capacity];
+    };
+
+    Slot slots[slotCount];
+    /** Next position a producer will claim */
+    std::atomic<uint32_t> head;
+    /** All positions before this one have been written out */
+    std::atomic<uint32_t> written;
+    std::atomic<bool> running;
+    char batch[batchSize];
+    std::thread flusher;
+
+    static void writeAll(const char *data, size_t length) {
+        while (length > 0) {
+            const ssize_t count = ::write(STDOUT_FILENO, data, length);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += count;
+            length -= count;
+        }
+    }
+
+    void run() {
+        uint32_t tail = 0;
+        while (true) {
+            size_t batchLength = 0;
+            while (batchLength + LineBuffer::capacity <= batchSize) {
+                Slot &slot = slots[tail % slotCount];
+                if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+                    break;
+                }
+                memcpy(batch + batchLength, slot.text, slot.length);
+                batchLength += slot.length;
+                slot.sequence.store(tail + slotCount, std::memory_order_release);
+                tail++;
+            }
+            if (batchLength > 0) {
+                writeAll(batch, batchLength);
+                written.store(tail, std::memory_order_release);
+            } else if (!running.load(std::memory_order_acquire)) {
+                return;
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+
+public:
+    Sink(): head(0), written(0), running(true) {
+        for (uint32_t i = 0; i < slotCount; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        flusher = std::thread([this] { run(); });
+    }
+
+    ~Sink() {
+        running.store(false, std::memory_order_release);
+        flusher.join();
+    }
+
+    void push(const LineBuffer &line) {
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = slots[pos % slotCount];
+            const int32_t diff = int32_t(slot.sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    memcpy(slot.text, line.getText(), line.getLength());
+                    slot.length = line.getLength();
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return;
+                }
+            } else {
+                if (diff < 0) {
+                    // The ring is full, so let the flusher catch up.
+                    std::this_thread::yield();
+                }
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void flush() {
+        const uint32_t target = head.load(std::memory_order_acquire);
+        while (int32_t(written.load(std::memory_order_acquire) - target) < 0) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+Sink &sink() {
+    static Sink instance;
+    return instance;
+}
+
+}
+
+LineBuffer &lineBuffer() {
+    static thread_local LineBuffer buffer;
+    return buffer;
+}
+
+void logLine(const LineBuffer &line) {
+    sink().push(line);
+}
+
+void flushLog() {
+    sink().flush();
+}
+
+}
+}
+
+#endif
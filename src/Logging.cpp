@@ -5,10 +5,8 @@ volatile uint8_t debugTimingsCount = 0;
 
 volatile uint16_t pls = 0;
 
-#ifndef AVR
 namespace Logging {
 namespace Impl {
-std::mutex logging_mutex;
+volatile uint8_t disabledLoggers[maskSize];
 }
 }
-#endif
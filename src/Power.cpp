@@ -26,13 +26,20 @@ INLINE static void sleep_bod_disable() {
 }
 
 void HAL::Atmel::Impl::sleep(SleepMode mode) {
-  auto adcsraSave = ADCSRA.get();
-    ADEN.clear(); // disable the ADC
+    // ADC noise reduction needs the ADC to keep running. Restoring ADCSRA afterwards would also re-start
+    // the conversion that woke us up, since ADSC still reads as set from before sleeping.
+    const bool keepADC = (mode == SleepMode::ADC);
+    auto adcsraSave = ADCSRA.get();
+    if (!keepADC) {
+        ADEN.clear(); // disable the ADC
+    }
     switch(mode) {
     case SleepMode::POWER_DOWN:
         SMCR.apply(~SM0 | SM1 | ~SM2); break;
     case SleepMode::STANDBY:
         SMCR.apply(~SM0 | SM1 | SM2); break;
+    case SleepMode::ADC:
+        SMCR.apply(SM0 | ~SM1 | ~SM2); break;
     case SleepMode::IDLE:
         SMCR.apply(~SM0 | ~SM1 | ~SM2); break;
     }
@@ -44,5 +51,7 @@ void HAL::Atmel::Impl::sleep(SleepMode mode) {
     }
     sleep_cpu();
     SE.clear(); // sleep disable
-    ADCSRA.set(adcsraSave);
+    if (!keepADC) {
+        ADCSRA.set(adcsraSave);
+    }
 }
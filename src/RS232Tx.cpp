@@ -0,0 +1,3 @@
+#include "Serial/RS232Tx.hpp"
+
+const Serial::Impl::RS232Schedules Serial::Impl::rs232Schedules PROGMEM;
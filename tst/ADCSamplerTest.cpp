@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "HAL/Atmel/ADCSampler.hpp"
+#include "Mocks.hpp"
+
+namespace ADCSamplerTest {
+
+using namespace HAL::Atmel;
+using namespace Mocks;
+
+struct MockPinA0 {
+    struct info_t {
+        static constexpr auto adc_mux = ~(MUX0 | MUX1 | MUX2 | MUX3);
+    };
+};
+
+struct MockPinA3 {
+    struct info_t {
+        static constexpr auto adc_mux = MUX0 | MUX1 | ~MUX2 | ~MUX3;
+    };
+};
+
+template <typename sampler_t>
+void convert(sampler_t &sampler, MockComparator<> &comparator, uint16_t value) {
+    comparator.advanceToTarget();
+    ADC.set(value);
+    invoke<Int_ADC_>(sampler);
+}
+
+TEST(ADCSamplerTest, auto_triggers_on_comparator_and_moves_it_one_period_ahead) {
+    MockComparator<> comparator;
+    MockPinA0 pin;
+    auto sampler = adcSampler(comparator, 100_us, pin);
+
+    EXPECT_TRUE(ADATE.isSet());
+    EXPECT_TRUE(ADIE.isSet());
+    EXPECT_TRUE(ADCSRB.matches(ADTS0 | ADTS1 | ~ADTS2));
+    EXPECT_EQ(200, comparator.target);
+    EXPECT_FALSE(comparator.isInterruptOn);
+
+    convert(sampler, comparator, 512);
+    EXPECT_EQ(144, comparator.target);  // 400 counts, wrapped around on the 8-bit timer
+    EXPECT_EQ(2, comparator.matchesCleared);
+
+    Impl::ADCSample sample;
+    EXPECT_TRUE(sampler.read(sample));
+    EXPECT_EQ(0, sample.channel);
+    EXPECT_EQ(512, sample.value);
+    EXPECT_FALSE(sampler.read(sample));
+}
+
+TEST(ADCSamplerTest, averages_oversampled_conversions_and_cycles_through_channels) {
+    MockComparator<> comparator;
+    MockPinA0 pinA0;
+    MockPinA3 pinA3;
+    auto sampler = adcSampler<1>(comparator, 100_us, pinA0, pinA3);
+    EXPECT_EQ(0, ADMUX.get() & 0x0F);
+
+    convert(sampler, comparator, 100);
+    EXPECT_EQ(0, ADMUX.get() & 0x0F);
+    convert(sampler, comparator, 102);
+    EXPECT_EQ(3, ADMUX.get() & 0x0F);
+    convert(sampler, comparator, 1000);
+    convert(sampler, comparator, 1003);
+    EXPECT_EQ(0, ADMUX.get() & 0x0F);
+
+    Impl::ADCSample sample;
+    EXPECT_TRUE(sampler.read(sample));
+    EXPECT_EQ(0, sample.channel);
+    EXPECT_EQ(101, sample.value);
+    EXPECT_TRUE(sampler.read(sample));
+    EXPECT_EQ(1, sample.channel);
+    EXPECT_EQ(1001, sample.value);
+    EXPECT_FALSE(sampler.read(sample));
+    EXPECT_EQ(1001, sampler.getLatest(1));
+}
+
+TEST(ADCSamplerTest, counts_samples_dropped_on_full_buffer) {
+    MockComparator<> comparator;
+    MockPinA0 pin;
+    auto sampler = adcSampler<0, 4>(comparator, 100_us, pin);
+
+    for (uint16_t i = 0; i < 5; i++) {
+        convert(sampler, comparator, i);
+    }
+    EXPECT_EQ(2, sampler.getOverflows());
+    EXPECT_EQ(4, sampler.getLatest(0));
+
+    Impl::ADCSample sample;
+    for (uint16_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(sampler.read(sample));
+        EXPECT_EQ(i, sample.value);
+    }
+    EXPECT_FALSE(sampler.read(sample));
+}
+
+}
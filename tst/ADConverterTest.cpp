@@ -1,4 +1,6 @@
 #include "HAL/Atmel/ADConverter.hpp"
+#include "HAL/Atmel/Power.hpp"
+#include "invoke.hpp"
 #include <gtest/gtest.h>
 
 namespace ADCTest {
@@ -23,4 +25,32 @@ TEST(ADCTest, ADC8_can_template) {
     adc.measure(pin);
 }
 
+TEST(ADCTest, awaits_conversion_in_adc_noise_reduction_sleep) {
+    MockPin pin;
+    ADConverter<uint16_t> adc;
+    EXPECT_TRUE(adc.getTaskState().isIdle());
+
+    adc.measure(pin);
+    EXPECT_FALSE(adc.getTaskState().isIdle());
+    EXPECT_EQ(SleepMode::ADC, adc.getTaskState().getMaxSleepMode());
+
+    uint8_t sleeps = 0;
+    onSleep_cpu = [&] {
+        EXPECT_TRUE(SM0.isSet());
+        EXPECT_FALSE(SM1.isSet());
+        EXPECT_FALSE(SM2.isSet());
+        EXPECT_TRUE(ADEN.isSet());
+        sleeps++;
+        ADSC.clear();
+        ADC.set(300);
+        invoke<Int_ADC_>(adc);
+    };
+    sei();
+    EXPECT_EQ(300, adc.awaitValue());
+    onSleep_cpu = nullptr;
+
+    EXPECT_EQ(1, sleeps);
+    EXPECT_TRUE(adc.getTaskState().isIdle());
+}
+
 }
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "BinaryLogDecoder.hpp"
+#include "Fifo.hpp"
+
+namespace BinaryLogTest {
+
+using namespace Logging;
+using namespace Streams;
+
+std::vector<uint8_t> drain(AbstractFifo &fifo) {
+    std::vector<uint8_t> bytes;
+    while (fifo.hasContent()) {
+        uint8_t b;
+        fifo.uncheckedRead(b);
+        bytes.push_back(b);
+    }
+    return bytes;
+}
+
+template <typename... types>
+std::string asText(types... args) {
+    Fifo<128> fifo;
+    fifo.write(args...);
+    std::string s;
+    for (uint8_t b: drain(fifo)) {
+        s += char(b);
+    }
+    return s;
+}
+
+TEST(BinaryLogTest, record_is_decoded_into_same_text_as_text_logging) {
+    const uint16_t values[] = { 12, 34 };
+    Fifo<128> fifo;
+    fifo.write(BinaryLog::record<STR("Tst")>(F("t="), dec(uint16_t(300)), F(" d="), dec(int8_t(-5)), ' ',
+                                              Hexadecimal(uint8_t(0xAB)), F(" v="), Decimal(values, 0, 2)));
+    const auto bytes = drain(fifo);
+    EXPECT_EQ(BinaryLog::RECORD_START, bytes.front());
+    EXPECT_EQ(BinaryLog::END, bytes.back());
+
+    BinaryLogDecoder decoder(sizeof(void*), BinaryLogDecoder::hostMemory());
+    const auto lines = decoder.decode(bytes.data(), bytes.size());
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_EQ("Tst: " + asText(F("t="), dec(uint16_t(300)), F(" d="), dec(int8_t(-5)), ' ',
+                               Hexadecimal(uint8_t(0xAB)), F(" v="), Decimal(values, 0, 2)), lines[0]);
+}
+
+TEST(BinaryLogTest, strings_and_ints_are_not_formatted_on_the_device) {
+    Fifo<128> fifo;
+    fifo.write(BinaryLog::record<STR("Tst")>(F("a rather long message describing a value: "), dec(uint32_t(4000000000))));
+    // start, logger, (tag, length, string), (tag, 4 bytes), end
+    EXPECT_EQ(1 + sizeof(void*) + 2 + sizeof(void*) + 5 + 1, fifo.getSize());
+}
+
+TEST(BinaryLogTest, decoder_waits_for_complete_records_and_skips_garbage) {
+    Fifo<128> fifo;
+    fifo.write(uint8_t(42), uint8_t(0x7F), uint8_t(BinaryLog::PSTR));
+    fifo.write(BinaryLog::record<STR("A")>(F("one")));
+    fifo.write(BinaryLog::record<STR("B")>(dec(int32_t(-100000))));
+    const auto bytes = drain(fifo);
+
+    BinaryLogDecoder decoder(sizeof(void*), BinaryLogDecoder::hostMemory());
+    std::vector<std::string> lines;
+    for (uint8_t b: bytes) {
+        for (auto &line: decoder.decode(&b, 1)) {
+            lines.push_back(line);
+        }
+    }
+    ASSERT_EQ(2u, lines.size());
+    EXPECT_EQ("A: one", lines[0]);
+    EXPECT_EQ("B: -100000", lines[1]);
+}
+
+TEST(BinaryLogTest, flash_image_catalog_reads_zero_terminated_strings_at_their_address) {
+    const std::vector<uint8_t> image = { 0, 'M', 0, 'h', 'i', '!', 0 };
+    const uint8_t bytes[] = { BinaryLog::RECORD_START, 1, 0, BinaryLog::PSTR, 2, 3, 0, BinaryLog::CHAR, '?', BinaryLog::END };
+
+    BinaryLogDecoder decoder(2, BinaryLogDecoder::flashImage(image));
+    const auto lines = decoder.decode(bytes, sizeof(bytes));
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_EQ("M: hi?", lines[0]);
+}
+
+}
@@ -172,6 +172,30 @@ TEST(ChunkedFifoTest, aborting_a_write_does_not_conclude_it) {
     EXPECT_EQ(0, data.getSize());
 }
 
+TEST(ChunkedFifoTest, reserved_byte_can_be_patched_after_visiting_later_bytes) {
+    Fifo<8> data;
+    ChunkedFifo f(data);
+    uint8_t x;
+    data.write(FB(1,1,1,1,1));           // move the write position close to the wrap-around
+    while (data.read(&x)) ;
+
+    volatile uint8_t *ptr;
+    f.writeStart();
+    EXPECT_TRUE(f.reserve(ptr));
+    f.write(FB(3,4,5));
+    uint8_t sum = 0;
+    f.forEachWrittenAfter(ptr, [&sum] (uint8_t b) { sum += b; });
+    *ptr = sum;
+    f.writeEnd();
+
+    uint8_t a, b, c, d;
+    EXPECT_TRUE(f.read(&a, &b, &c, &d));
+    EXPECT_EQ(12, a);
+    EXPECT_EQ(3, b);
+    EXPECT_EQ(4, c);
+    EXPECT_EQ(5, d);
+}
+
 TEST(ChunkedFifoTest, aborting_a_read_does_not_conclude_it) {
     Fifo<2> data;
     ChunkedFifo f(data);
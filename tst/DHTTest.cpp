@@ -11,11 +11,69 @@ using namespace Mocks;
 using namespace DHT;
 using namespace HAL::Atmel;
 
-TEST(DHTTest, powers_on_before_measuring) {
+struct DHTTest: public ::testing::Test {
     MockComparator<> comparator;
     MockPin pin, power;
     MockRealTimer rt;
 
+    template <typename dht_t>
+    void startMeasurement(dht_t &dht) {
+        dht.measure();
+        EXPECT_EQ(DHTState::SIGNALING, dht.getState());
+        EXPECT_TRUE(pin.isOutput);
+        EXPECT_FALSE(pin.high);
+
+        // after 18ms, switch to input and record the sensor's response
+        rt.advance(18_ms);
+        dht.loop();
+        EXPECT_FALSE(pin.isOutput);
+        EXPECT_EQ(DHTState::RECEIVING, dht.getState());
+        EXPECT_TRUE(pin.isInterruptOn);
+    }
+
+    template <typename dht_t, typename duration_t>
+    void edge(dht_t &dht, bool high, duration_t duration) {
+        comparator.advance(duration);
+        pin.high = high;
+        invoke<MockPin::INT>(dht);
+        dht.loop();
+    }
+
+    template <typename dht_t>
+    void sendSync(dht_t &dht) {
+        pin.high = false;
+        comparator.advance();
+        invoke<MockPin::INT>(dht);  // start of the low sync pulse
+        edge(dht, true, 80_us);
+        edge(dht, false, 80_us);
+    }
+
+    template <typename dht_t, typename low_t>
+    void sendByte(dht_t &dht, uint8_t data, low_t lowLength) {
+        for (int8_t bit = 7; bit >= 0; bit--) {
+            edge(dht, true, lowLength);
+            if ((data & (1 << bit)) != 0) {
+                edge(dht, false, 70_us);
+            } else {
+                edge(dht, false, 30_us);
+            }
+        }
+    }
+
+    template <typename dht_t>
+    void finishFrame(dht_t &dht) {
+        edge(dht, true, 50_us);
+        // the frame is decoded at once, when it's guaranteed to be over
+        EXPECT_EQ(DHTState::RECEIVING, dht.getState());
+        rt.advance(8_ms);
+        dht.loop();
+        EXPECT_EQ(DHTState::IDLE, dht.getState());
+        EXPECT_FALSE(pin.isInterruptOn);
+        EXPECT_FALSE(comparator.isInterruptOn);
+    }
+};
+
+TEST_F(DHTTest, powers_on_before_measuring) {
     auto dht = DHT11(pin, power, comparator, rt);
     dht.powerOff();
     EXPECT_FALSE(pin.isOutput);
@@ -31,11 +89,7 @@ TEST(DHTTest, powers_on_before_measuring) {
     EXPECT_EQ(DHTState::IDLE, dht.getState());
 }
 
-TEST(DHTTest, dht11_reads_5_bytes_and_updates_temperature_and_humidity) {
-    MockComparator<> comparator;
-    MockPin pin, power;
-    MockRealTimer rt;
-
+TEST_F(DHTTest, dht11_reads_5_bytes_and_updates_temperature_and_humidity) {
     auto dht = DHT11(pin, power, comparator, rt);
     EXPECT_EQ(none(), dht.getHumidity());
     EXPECT_EQ(none(), dht.getTemperature());
@@ -43,200 +97,73 @@ TEST(DHTTest, dht11_reads_5_bytes_and_updates_temperature_and_humidity) {
     EXPECT_TRUE(power.isOutput);
     EXPECT_TRUE(power.high);
 
-    // after 1 second, pin should be pulled low for 18ms
     rt.advance(1_s);
     dht.loop();
-    dht.measure();
-    EXPECT_EQ(DHTState::SIGNALING, dht.getState());
-    EXPECT_TRUE(pin.isOutput);
-    EXPECT_FALSE(pin.high);
-
-    // after 18ms, switch to input and wait for low sync pulse
-    rt.advance(18_ms);
-    dht.loop();
-    EXPECT_FALSE(pin.isOutput);
-    EXPECT_EQ(DHTState::SYNC_LOW, dht.getState());
-
-    // low sync pulse should take 60..120us
-    pin.high = false;
-    comparator.advance();
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    std::cout << "----" <<std::endl;
-    //dht.onPinChange();
-    invoke<MockPin::INT>(dht);
-    pin.high = true;
-    comparator.advance(80_us);
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    dht.loop();
-    dht.loop();
-    dht.loop();
-    EXPECT_EQ(DHTState::SYNC_HIGH, dht.getState());
-
-    // high sync pulse should take 60..120us
-    pin.high = false;
-    comparator.advance(80_us);
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    dht.loop();
-    EXPECT_EQ(DHTState::RECEIVING_LOW, dht.getState());
-
-    auto sendTestBit = [&] (bool isOne) {
-        pin.high = true;
-        comparator.advance(50_us);
-        invoke<MockPin::INT>(dht);
-        dht.loop();
-
-        pin.high = false;
-        if (isOne) {
-            comparator.advance(70_us);
-        } else {
-            comparator.advance(30_us);
-        }
-        invoke<MockPin::INT>(dht);
-        dht.loop();
-    };
-
-    auto sendTestByte = [&] (uint8_t data) {
-        for (int8_t bit = 7; bit >= 0; bit--) {
-            sendTestBit((data & (1 << bit)) != 0);
-        }
-    };
-
-    sendTestByte(32);
-    sendTestByte(0);
-    sendTestByte(27);
-    sendTestByte(0);
-    sendTestByte(59);
+    startMeasurement(dht);
+    sendSync(dht);
+    for (uint8_t b: { 32, 0, 27, 0, 59 }) {
+        sendByte(dht, b, 50_us);
+    }
+    finishFrame(dht);
 
+    EXPECT_EQ(0, dht.getLastFailure());
     EXPECT_EQ(some(320), dht.getHumidity());
     EXPECT_EQ(some(270), dht.getTemperature());
-    EXPECT_EQ(DHTState::IDLE, dht.getState());
-    EXPECT_FALSE(pin.isInterruptOn);
-    EXPECT_FALSE(comparator.isInterruptOn);
 
     // Let's take a second measurement
-    dht.measure();
-    EXPECT_EQ(DHTState::SIGNALING, dht.getState());
-    EXPECT_TRUE(pin.isOutput);
-    EXPECT_FALSE(pin.high);
-
-    // after 18ms, switch to input and wait for low sync pulse
-    rt.advance(18_ms);
-    dht.loop();
-    EXPECT_FALSE(pin.isOutput);
-    EXPECT_EQ(DHTState::SYNC_LOW, dht.getState());
-
-    // low sync pulse should take 60..120us
-    pin.high = false;
-    comparator.advance();
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    pin.high = true;
-    comparator.advance(80_us);
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    dht.loop();
-    dht.loop();
-    dht.loop();
-    EXPECT_EQ(DHTState::SYNC_HIGH, dht.getState());
-
-    // high sync pulse should take 60..120us
-    pin.high = false;
-    comparator.advance(80_us);
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    dht.loop();
-    EXPECT_EQ(DHTState::RECEIVING_LOW, dht.getState());
-
-    sendTestByte(2);
-    sendTestByte(0);
-    sendTestByte(42);
-    sendTestByte(0);
-    sendTestByte(59);
+    startMeasurement(dht);
+    sendSync(dht);
+    for (uint8_t b: { 2, 0, 42, 0, 44 }) {
+        sendByte(dht, b, 50_us);
+    }
+    finishFrame(dht);
 
     EXPECT_EQ(some(20), dht.getHumidity());
     EXPECT_EQ(some(420), dht.getTemperature());
-    EXPECT_EQ(DHTState::IDLE, dht.getState());
-    EXPECT_FALSE(pin.isInterruptOn);
-    EXPECT_FALSE(comparator.isInterruptOn);
 }
 
-TEST(DHTTest, dht22_reads_negative_temperatures) {
-    MockComparator<> comparator;
-    MockPin pin, power;
-    MockRealTimer rt;
-
+TEST_F(DHTTest, dht22_reads_negative_temperatures) {
     auto dht = DHT22(pin, power, comparator, rt);
     EXPECT_FALSE(pin.isOutput);
 
-    // after 1 second, pin should be pulled low for 18ms
     rt.advance(1_s);
     dht.loop();
-    dht.measure();
-    EXPECT_EQ(DHTState::SIGNALING, dht.getState());
-    EXPECT_TRUE(pin.isOutput);
-    EXPECT_FALSE(pin.high);
+    startMeasurement(dht);
+    sendSync(dht);
+    for (uint8_t b: { 0b00000010, 0b10001100, 0b10000000, 0b01100101, 0b01110011 }) {
+        sendByte(dht, b, 71_us); // my DHT22 sends rather slow "low" pulses
+    }
+    finishFrame(dht);
 
-    // after 18ms, switch to input and wait for low sync pulse
-    rt.advance(18_ms);
-    dht.loop();
-    EXPECT_FALSE(pin.isOutput);
-    EXPECT_EQ(DHTState::SYNC_LOW, dht.getState());
-
-    // low sync pulse should take 60..120us
-    pin.high = false;
-    comparator.advance();
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    pin.high = true;
-    comparator.advance(80_us);
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
-    dht.loop();
-    dht.loop();
-    dht.loop();
-    EXPECT_EQ(DHTState::SYNC_HIGH, dht.getState());
+    EXPECT_EQ(some(652), dht.getHumidity());
+    EXPECT_EQ(some(-101), dht.getTemperature());
+}
 
-    // high sync pulse should take 60..120us
-    pin.high = false;
-    comparator.advance(80_us);
-    EXPECT_TRUE(pin.isInterruptOn);
-    invoke<MockPin::INT>(dht);
+TEST_F(DHTTest, drops_frame_with_invalid_checksum) {
+    auto dht = DHT11(pin, power, comparator, rt);
+    rt.advance(1_s);
     dht.loop();
-    EXPECT_EQ(DHTState::RECEIVING_LOW, dht.getState());
-
-    auto sendTestBit = [&] (bool isOne) {
-        pin.high = true;
-        comparator.advance(71_us); // my DHT22 sends rather slow "low" pulses
-        invoke<MockPin::INT>(dht);
-        dht.loop();
-
-        pin.high = false;
-        if (isOne) {
-            comparator.advance(70_us);
-        } else {
-            comparator.advance(30_us);
-        }
-        invoke<MockPin::INT>(dht);
-        dht.loop();
-    };
+    startMeasurement(dht);
+    sendSync(dht);
+    for (uint8_t b: { 32, 0, 27, 0, 60 }) {
+        sendByte(dht, b, 50_us);
+    }
+    finishFrame(dht);
 
-    auto sendTestByte = [&] (uint8_t data) {
-        for (int8_t bit = 7; bit >= 0; bit--) {
-            sendTestBit((data & (1 << bit)) != 0);
-        }
-    };
+    EXPECT_EQ(int(decltype(dht)::CHECKSUM), dht.getLastFailure());
+    EXPECT_EQ(none(), dht.getHumidity());
+}
 
-    sendTestByte(0b00000010);
-    sendTestByte(0b10001100);
-    sendTestByte(0b10000000);
-    sendTestByte(0b01100101);
-    sendTestByte(59);
+TEST_F(DHTTest, reports_incomplete_frame_after_timeout) {
+    auto dht = DHT11(pin, power, comparator, rt);
+    rt.advance(1_s);
+    dht.loop();
+    startMeasurement(dht);
+    sendSync(dht);
+    sendByte(dht, 32, 50_us);
+    finishFrame(dht);
 
-    EXPECT_EQ(some(652), dht.getHumidity());
-    EXPECT_EQ(some(-101), dht.getTemperature());
+    EXPECT_EQ(int(decltype(dht)::INCOMPLETE), dht.getLastFailure());
 }
 
 }
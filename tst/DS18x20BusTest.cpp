@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "Dallas/DS18x20Bus.hpp"
+#include "Mocks.hpp"
+
+namespace DS18x20BusTest {
+
+using namespace Dallas;
+using namespace Mocks;
+
+const uint8_t rom[] = { 0x28, 0xFF, 0x4B, 0x01, 0x00, 0x00, 0x80, 0xD2 };
+const uint8_t scratchpad[] = { 0x91, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0F, 0x10, 0x25 };
+
+void respondToSearch(MockOneWirePin &pin) {
+    pin.samples.push_back(false);  // presence
+    for (uint8_t i = 0; i < 64; i++) {
+        const bool bit = (rom[i / 8] >> (i % 8)) & 1;
+        pin.samples.push_back(bit);
+        pin.samples.push_back(!bit);
+    }
+}
+
+void respondWithScratchpad(MockOneWirePin &pin, uint8_t corruptByte = 0xFF) {
+    pin.samples.push_back(false);  // presence
+    for (uint8_t i = 0; i < 72; i++) {
+        uint8_t b = scratchpad[i / 8];
+        if (i / 8 == corruptByte) {
+            b ^= 0x04;
+        }
+        pin.samples.push_back((b >> (i % 8)) & 1);
+    }
+}
+
+template <typename master_t>
+void runUntilIdle(master_t &master, MockComparator<> &comparator) {
+    for (int i = 0; i < 10000 && comparator.isInterruptOn; i++) {
+        comparator.advanceToTargetAndInvoke(master);
+    }
+}
+
+struct DS18x20BusTest: public ::testing::Test {
+    MockOneWirePin pin;
+    MockComparator<> comparator;
+    MockRealTimer rt;
+    Dallas::Impl::OneWireMaster<MockOneWirePin, MockComparator<>, 32, 32> wire = { pin, comparator, true };
+
+    template <typename bus_t>
+    void discover(bus_t &bus) {
+        runUntilIdle(wire, comparator);
+        bus.loop();  // first device found, searching for next
+        runUntilIdle(wire, comparator);
+        bus.loop();  // no more devices
+    }
+
+    template <typename bus_t>
+    void measure(bus_t &bus, uint8_t corruptByte = 0xFF) {
+        pin.samples.push_back(false);  // presence on the convert broadcast
+        respondWithScratchpad(pin, corruptByte);
+        bus.measure();
+        runUntilIdle(wire, comparator);
+        EXPECT_EQ(HAL::Atmel::SleepMode::POWER_DOWN, bus.getTaskState().getMaxSleepMode());
+        bus.loop();
+        EXPECT_FALSE(bus.isIdle());
+
+        rt.advance(750_ms);
+        bus.loop();
+        runUntilIdle(wire, comparator);
+        bus.loop();
+    }
+};
+
+TEST_F(DS18x20BusTest, discovers_sensor_and_reads_its_temperature_after_one_broadcast_conversion) {
+    respondToSearch(pin);
+    auto bus = DS18x20Bus(wire, rt);
+    discover(bus);
+    EXPECT_TRUE(bus.isIdle());
+    EXPECT_EQ(1, bus.getCount());
+    EXPECT_EQ(0x28, bus.getAddress(0).addr[0]);
+
+    measure(bus);
+
+    EXPECT_TRUE(pin.samples.empty());
+    EXPECT_TRUE(bus.isIdle());
+    EXPECT_TRUE(bus.getTemperature(0).isDefined());
+    EXPECT_EQ(250, bus.getTemperature(0).get());
+    EXPECT_EQ(0, bus.getCRCErrors());
+}
+
+TEST_F(DS18x20BusTest, drops_temperature_with_invalid_scratchpad_crc) {
+    respondToSearch(pin);
+    auto bus = DS18x20Bus(wire, rt);
+    discover(bus);
+
+    measure(bus, 1);
+
+    EXPECT_TRUE(bus.isIdle());
+    EXPECT_TRUE(bus.getTemperature(0).isEmpty());
+    EXPECT_EQ(1, bus.getCRCErrors());
+}
+
+}
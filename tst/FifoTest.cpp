@@ -385,3 +385,25 @@ TEST(FifoTest, getSpace_does_not_count_marked_reads) {
     fifo.readEnd();
     EXPECT_EQ(2, fifo.getSpace());
 }
+
+TEST(FifoTest, read_span_stops_at_wrap_around_and_is_released_by_skip) {
+    Fifo<3> fifo;
+    uint8_t b;
+    fifo.write(FB(1,2,3));
+    fifo.read(&b, &b);
+    fifo.write(FB(4,5));       // buffer is now [5, -, 3, 4]
+
+    volatile uint8_t *ptr;
+    EXPECT_EQ(2, fifo.fastReadSpan(ptr));
+    EXPECT_EQ(3, ptr[0]);
+    EXPECT_EQ(4, ptr[1]);
+    EXPECT_TRUE(fifo.fastIsFull());
+
+    fifo.fastSkip(2);
+    EXPECT_FALSE(fifo.fastIsFull());
+    EXPECT_EQ(1, fifo.fastReadSpan(ptr));
+    EXPECT_EQ(5, ptr[0]);
+    fifo.fastSkip(1);
+    EXPECT_TRUE(fifo.isEmpty());
+    EXPECT_EQ(0, fifo.fastReadSpan(ptr));
+}
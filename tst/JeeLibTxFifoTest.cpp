@@ -91,3 +91,22 @@ TEST(RFM12JeeLibTxFifo, empty_packet_is_encoded_with_preamble_crc_and_postfix) {
     fifo.read(b);
     EXPECT_EQ(0xAA, b); // postfix
 }
+
+TEST(RFM12JeeLibTxFifo, preamble_length_can_be_changed) {
+    JeeLibTxFifoCallbackTest cb;
+    JeeLibTxFifo<JeeLibTxFifoCallbackTest,JeeLibTxFifoCallbackTest> fifo(cb);
+    fifo.setPreambleLength(5);
+
+    fifo.write_fsk(0);
+    EXPECT_TRUE(fifo.readStart());
+
+    uint8_t b;
+    for (int i = 0; i < 5; i++) {
+        fifo.read(b);
+        EXPECT_EQ(0xAA, b);
+    }
+    fifo.read(b);
+    EXPECT_EQ(0x2D, b);
+    fifo.read(b);
+    EXPECT_EQ(5, b); // groupId
+}
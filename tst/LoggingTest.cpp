@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "Logging.hpp"
+#include <sstream>
+#include <thread>
+
+namespace LoggingTest {
+
+using namespace Logging;
+using namespace Streams;
+
+typedef MessagesSwitchable<Loggers::PIR, STR("PIR")> pir;
+typedef MessagesSwitchable<Loggers::Ambient, STR("Ambient")> ambient;
+
+std::string logged(void (*log)()) {
+    MessagesEnabled<>::flush();
+    fflush(stdout);
+    testing::internal::CaptureStdout();
+    log();
+    MessagesEnabled<>::flush();
+    return testing::internal::GetCapturedStdout();
+}
+
+TEST(LoggingTest, switchable_loggers_start_enabled) {
+    EXPECT_TRUE(pir::isDebugEnabled());
+    EXPECT_TRUE(ambient::isDebugEnabled());
+    EXPECT_EQ("[      PIR ] hello\n", logged([] { pir::debug(F("hello")); }));
+}
+
+TEST(LoggingTest, disabling_one_logger_leaves_the_others_enabled) {
+    disable<Loggers::PIR>();
+    EXPECT_FALSE(pir::isDebugEnabled());
+    EXPECT_TRUE(ambient::isDebugEnabled());
+    EXPECT_EQ("", logged([] { pir::debug(F("hello")); }));
+    EXPECT_EQ(0u, getMask() & (uint32_t(1) << pir::bit));
+
+    enable<Loggers::PIR>();
+    EXPECT_TRUE(pir::isDebugEnabled());
+}
+
+TEST(LoggingTest, mask_has_one_bit_per_logger_in_order_of_all_loggers) {
+    setMask(uint32_t(1) << int(ambient::bit));
+    EXPECT_EQ(19, int(ambient::bit));
+    EXPECT_TRUE(ambient::isDebugEnabled());
+    EXPECT_FALSE(pir::isDebugEnabled());
+    EXPECT_EQ(uint32_t(1) << int(ambient::bit), getMask() & 0xFFFFF);
+
+    setMask(0xFFFFFFFF);
+    EXPECT_TRUE(pir::isDebugEnabled());
+}
+
+TEST(LoggingTest, loggers_that_are_not_switchable_ignore_the_mask) {
+    static_assert(!MessagesDisabled::isDebugEnabled(), "Disabled loggers should be known at compile time");
+    setMask(0);
+    EXPECT_TRUE(MessagesEnabled<STR("X")>::isDebugEnabled());
+    setMask(0xFFFFFFFF);
+}
+
+TEST(LoggingTest, lines_from_several_threads_are_written_whole) {
+    const std::string output = logged([] {
+        auto logMany = [] {
+            for (uint16_t i = 0; i < 500; i++) {
+                ambient::debug(F("value "), dec(i), F(" of 500"));
+            }
+        };
+        std::thread a(logMany), b(logMany);
+        a.join();
+        b.join();
+    });
+
+    std::istringstream lines(output);
+    std::string line;
+    uint16_t count = 0;
+    while (std::getline(lines, line)) {
+        EXPECT_EQ(0u, line.find("[  Ambient ] value ")) << line;
+        EXPECT_EQ(line.size() - 7, line.find(" of 500")) << line;
+        count++;
+    }
+    EXPECT_EQ(1000, count);
+}
+
+}
@@ -7,7 +7,10 @@
 #include "Time/TimerValue.hpp"
 #include <gtest/gtest.h>
 #include "Fifo.hpp"
+#include "HAL/Atmel/TWI.hpp"
 #include <limits.h>
+#include <deque>
+#include <string>
 #include "invoke.hpp"
 
 namespace Mocks {
@@ -23,9 +26,14 @@ struct MockComparator {
     typedef TimerValue<MockComparator<_value_t, _prescalerPower2>> timervalue_t;
     typedef Int_TIMER0_COMPA_ INT;
 
+    struct comparator_info_t {
+        static constexpr auto ADTS = Registers::ADTS0 | Registers::ADTS1 | ~Registers::ADTS2;
+    };
+
     value_t value = 0;
     value_t target = 0;
     bool isInterruptOn = false;
+    uint8_t matchesCleared = 0;
     NonPWMOutputMode mode = NonPWMOutputMode::disconnected;
 
     void advance() {
@@ -55,6 +63,10 @@ struct MockComparator {
         isInterruptOn = true;
     }
 
+    void clearMatch() {
+        matchesCleared++;
+    }
+
     timervalue_t getValue() const {
         return value;
     }
@@ -146,6 +158,40 @@ struct MockPin {
     }
 };
 
+/** Records the master's actions on the bus, and returns [samples] when the master reads the released bus. */
+struct MockOneWirePin: public MockPin {
+    std::string events;
+    std::deque<bool> samples;
+
+    void configureAsOutputLow() {
+        MockPin::configureAsOutputLow();
+        events += 'L';
+    }
+
+    void setHigh() {
+        MockPin::setHigh();
+        events += 'H';
+    }
+
+    void configureAsInputWithPullup() {
+        MockPin::configureAsInputWithPullup();
+        events += 'R';
+    }
+
+    bool isHigh() {
+        if (samples.empty()) {
+            return true;
+        }
+        const bool b = samples.front();
+        samples.pop_front();
+        return b;
+    }
+
+    bool isLow() {
+        return !isHigh();
+    }
+};
+
 template <typename _value_t = uint8_t, uint8_t _prescalerPower2 = 3>
 struct MockPinOnComparator: public MockPin {
 	typedef MockComparator<_value_t, _prescalerPower2> comparator_t;
@@ -191,14 +237,30 @@ struct MockTWI {
     uint8_t writeAddress;
     uint8_t readAddress;
 
-    template <typename... types> void write(uint8_t address, types... args) {
+    HAL::Atmel::AbstractTWIResult *result = nullptr;
+    uint8_t readCount = 0;
+    uint8_t transactions = 0;
+
+    template <typename... types> bool write(uint8_t address, types... args) {
         writeAddress = address;
-        out.write(args...);
+        transactions++;
+        return out.write(args...);
     }
     template <typename... types> Streams::ReadResult read(uint8_t address, types... args) {
         readAddress = address;
         return in.read(args...);
     }
+    template <typename... types>
+    bool transceive(uint8_t address, HAL::Atmel::AbstractTWIResult *r, uint8_t count, types... args) {
+        readAddress = address;
+        readCount = count;
+        result = r;
+        r->start();
+        return write(address, args...);
+    }
+    bool isTransceiving() const {
+        return result != nullptr && result->isPending();
+    }
 };
 
 struct MockRFM12 {
@@ -210,8 +272,8 @@ struct MockRFM12 {
     ChunkedFifo::In in() { return recv.in(); }
 
     template <typename... types>
-    void write_fsk(uint8_t header, types... args) {
-        sendFsk.write(header, args...);
+    bool write_fsk(uint8_t header, types... args) {
+        return sendFsk.write(header, args...);
     }
 };
 
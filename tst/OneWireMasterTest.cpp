@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "Dallas/OneWireMaster.hpp"
+#include "Mocks.hpp"
+
+namespace OneWireMasterTest {
+
+using namespace Dallas;
+using namespace Mocks;
+using namespace Streams;
+
+template <typename master_t>
+void runUntilIdle(master_t &master, MockComparator<> &comparator, MockOneWirePin &pin) {
+    for (int i = 0; i < 10000 && comparator.isInterruptOn; i++) {
+        comparator.advanceToTargetAndInvoke(master);
+        pin.events += '|';
+    }
+    EXPECT_TRUE(master.isIdle());
+}
+
+TEST(OneWireMasterTest, reset_reports_presence_pulse) {
+    MockOneWirePin pin;
+    MockComparator<> comparator;
+    auto master = OneWireMasterParasitePower(pin, comparator);
+
+    pin.samples = { false };
+    EXPECT_TRUE(master.reset());
+    EXPECT_TRUE(comparator.isInterruptOn);
+    EXPECT_FALSE(master.isIdle());
+    runUntilIdle(master, comparator, pin);
+
+    uint8_t present = 0;
+    EXPECT_EQ(ReadResult::Valid, master.in().read(&present));
+    EXPECT_EQ(1, present);
+}
+
+TEST(OneWireMasterTest, writes_bits_lsb_first_as_short_or_long_low_pulses) {
+    MockOneWirePin pin;
+    MockComparator<> comparator;
+    auto master = OneWireMasterParasitePower(pin, comparator);
+    pin.events = "";
+
+    EXPECT_TRUE(master.write(uint8_t(0x05)));
+    runUntilIdle(master, comparator, pin);
+
+    // a 1 is a short low pulse, and then a full slot that takes two comparator periods on an 8-bit timer
+    std::string expected = "LH||L|H|LH||L|H|";  // 1 0 1 0
+    expected += "L|H|L|H|L|H|L|H|";             // 0 0 0 0
+    expected += "|";                            // no more commands
+    EXPECT_EQ(expected, pin.events);
+}
+
+TEST(OneWireMasterTest, reads_bytes_lsb_first) {
+    MockOneWirePin pin;
+    MockComparator<> comparator;
+    auto master = OneWireMasterUnpowered(pin, comparator);
+
+    pin.samples = { false, true, true, false, false, false, false, true };
+    EXPECT_TRUE(master.read(1));
+    runUntilIdle(master, comparator, pin);
+
+    uint8_t b = 0;
+    EXPECT_EQ(ReadResult::Valid, master.in().read(&b));
+    EXPECT_EQ(0x86, b);
+}
+
+TEST(OneWireMasterTest, search_finds_single_device_and_then_ends) {
+    MockOneWirePin pin;
+    MockComparator<> comparator;
+    auto master = OneWireMasterParasitePower(pin, comparator);
+    const uint8_t rom[] = { 0x28, 0xFF, 0x4B, 0x01, 0x00, 0x00, 0x80, 0x9A };
+
+    pin.samples = { false };  // presence
+    for (uint8_t i = 0; i < 64; i++) {
+        const bool bit = (rom[i / 8] >> (i % 8)) & 1;
+        pin.samples.push_back(bit);
+        pin.samples.push_back(!bit);
+    }
+    EXPECT_TRUE(master.search());
+    runUntilIdle(master, comparator, pin);
+    EXPECT_TRUE(pin.samples.empty());
+
+    OneWireAddress addr;
+    EXPECT_TRUE(master.readSearchResult(addr));
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_EQ(rom[i], addr.addr[i]);
+    }
+
+    EXPECT_TRUE(master.search());
+    runUntilIdle(master, comparator, pin);
+    EXPECT_FALSE(master.readSearchResult(addr));
+}
+
+}
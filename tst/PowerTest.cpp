@@ -42,6 +42,20 @@ TEST(PowerTest, sleep_with_IDLE_does_not_adjust_timer) {
     EXPECT_EQ(0, rt.slept);
 }
 
+TEST(PowerTest, sleep_with_ADC_sleeps_once_until_conversion_completes) {
+    MockRealTimer rt;
+    auto power = Power<MockRealTimer>(rt);
+    uint8_t sleeps = 0;
+    onSleep_cpu = [&sleeps] {
+        sleeps++;
+    };
+    power.sleepUntilTasks(TaskState::busy(SleepMode::ADC), TaskState::busy(1000_ms, SleepMode::POWER_DOWN));
+    EXPECT_EQ(1, sleeps);
+    EXPECT_EQ(0, rt.slept);
+
+    onSleep_cpu = nullptr;
+}
+
 TEST(PowerTest, can_sleep_until_deadline) {
     MockRealTimer rt;
     auto power = Power<MockRealTimer>(rt);
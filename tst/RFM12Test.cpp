@@ -268,4 +268,71 @@ TEST(RFM12Test, can_send_multiple_queued_ook_packets) {
     EXPECT_TRUE(spi.tx.read(FB(184,0,130,13,130,221))); // Empty TX reg, Idle, Turn on RX
 }
 
+TEST(RFM12Test, duty_cycled_listening_sleeps_between_windows_and_extends_on_preamble) {
+    MockSPIMaster spi;
+    MockSSPin ss_pin;
+    MockIntPin int_pin;
+    MockComparator comp;
+    auto rfm = rfm12(spi, ss_pin, int_pin, comp, RFM12Band::_868Mhz);
+    EXPECT_EQ(RFM12Mode::LISTENING, rfm.getMode());
+
+    spi.tx.clear();
+    rfm.onIdleListenPeriodically(1_s, 5_ms);
+    EXPECT_EQ(RFM12Mode::LISTENING, rfm.getMode());
+    EXPECT_TRUE(spi.tx.read(FB(130,13,224,4,130,223))); // Idle, 5ms wake-up timer, RX on with wake-up timer
+    EXPECT_FALSE(rfm.getTaskState().isIdle());
+
+    spi.rx.write(uint8_t(1 << 4)); // WKUP
+    spi.rx.write(uint8_t(0));
+    spi.tx.clear();
+    invoke<MockIntPin::INT>(rfm);
+    EXPECT_EQ(RFM12Mode::SLEEP, rfm.getMode());
+    EXPECT_TRUE(spi.tx.read(FB(0,0,226,242,130,7))); // status, 1s wake-up timer, sleep with wake-up timer
+    EXPECT_TRUE(rfm.getTaskState().isIdle());
+
+    spi.rx.write(uint8_t(1 << 4)); // WKUP
+    spi.rx.write(uint8_t(0));
+    spi.tx.clear();
+    invoke<MockIntPin::INT>(rfm);
+    EXPECT_EQ(RFM12Mode::LISTENING, rfm.getMode());
+    EXPECT_TRUE(spi.tx.read(FB(0,0,224,4,130,223)));
+
+    spi.rx.write(uint8_t(1 << 4)); // WKUP
+    spi.rx.write(uint8_t(1 << 7)); // DQD
+    spi.tx.clear();
+    invoke<MockIntPin::INT>(rfm);
+    EXPECT_EQ(RFM12Mode::LISTENING, rfm.getMode());
+    EXPECT_TRUE(spi.tx.read(FB(0,0,130,221,224,4,130,223))); // Re-arm window
+
+    spi.tx.clear();
+    rfm.onIdleListen();
+    EXPECT_EQ(RFM12Mode::LISTENING, rfm.getMode());
+    EXPECT_TRUE(spi.tx.read(FB(130,13,130,221))); // Idle, continuous RX on
+}
+
+TEST(RFM12Test, stretched_preamble_is_sent_in_front_of_fsk_packet) {
+    MockSPIMaster spi;
+    MockSSPin ss_pin;
+    MockIntPin int_pin;
+    MockComparator comp;
+    auto rfm = rfm12(spi, ss_pin, int_pin, comp, RFM12Band::_868Mhz);
+
+    rfm.stretchPreamble(1_ms);
+    spi.tx.clear();
+    rfm.write_fsk(0);
+    EXPECT_EQ(RFM12Mode::SENDING_FSK, rfm.getMode());
+    EXPECT_TRUE(spi.tx.read(FB(130,13,130,61))); // Idle, TX on
+
+    for (int i = 0; i < 7; i++) {
+        spi.rx.write(uint8_t(1 << 7));
+        spi.rx.write(uint8_t(0));
+        invoke<MockIntPin::INT>(rfm);
+        EXPECT_TRUE(spi.tx.read(FB(0,0,184,0xAA)));
+    }
+    spi.rx.write(uint8_t(1 << 7));
+    spi.rx.write(uint8_t(0));
+    invoke<MockIntPin::INT>(rfm);
+    EXPECT_TRUE(spi.tx.read(FB(0,0,184,0x2D)));
+}
+
 }
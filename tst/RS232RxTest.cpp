@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "Serial/RS232Rx.hpp"
+#include "Mocks.hpp"
+#include "invoke.hpp"
+
+namespace RS232RxTest {
+
+using namespace Mocks;
+using namespace Serial;
+
+typedef MockComparator<uint8_t, 3> comparator_t;
+typedef Serial::Impl::RS232Rx<MockPin, comparator_t, 38400, 16> rx_t;
+
+void sendByte(MockPin &pin, comparator_t &comparator, rx_t &rx, uint8_t value, bool stopBit = true) {
+    pin.high = false;
+    invoke<MockPin::INT>(rx);
+    EXPECT_FALSE(pin.isInterruptOn);
+    EXPECT_TRUE(comparator.isInterruptOn);
+
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        pin.high = ((value >> bit) & 1) != 0;
+        comparator.advanceToTargetAndInvoke(rx);
+    }
+    pin.high = stopBit;
+    comparator.advanceToTargetAndInvoke(rx);
+    EXPECT_TRUE(pin.isInterruptOn);
+    EXPECT_FALSE(comparator.isInterruptOn);
+    pin.high = true;
+    invoke<MockPin::INT>(rx);
+}
+
+TEST(RS232RxTest, samples_bits_in_their_middle) {
+    MockPin pin;
+    comparator_t comparator;
+    comparator.value = 200;
+    rx_t rx(pin, comparator);
+    EXPECT_EQ(52, int(rx.bitLength));
+
+    pin.high = false;
+    invoke<MockPin::INT>(rx);
+    EXPECT_EQ(uint8_t(200 + 78), comparator.target);
+    comparator.advanceToTargetAndInvoke(rx);
+    EXPECT_EQ(uint8_t(200 + 78 + 52), comparator.target);
+}
+
+TEST(RS232RxTest, receives_back_to_back_bytes) {
+    MockPin pin;
+    comparator_t comparator;
+    rx_t rx(pin, comparator);
+
+    sendByte(pin, comparator, rx, 0x55);
+    sendByte(pin, comparator, rx, 0x00);
+    sendByte(pin, comparator, rx, 0xFF);
+    sendByte(pin, comparator, rx, 0x81);
+
+    uint8_t a, b, c, d;
+    EXPECT_TRUE(rx.in().read(&a, &b, &c, &d));
+    EXPECT_EQ(0x55, a);
+    EXPECT_EQ(0x00, b);
+    EXPECT_EQ(0xFF, c);
+    EXPECT_EQ(0x81, d);
+}
+
+TEST(RS232RxTest, ignores_rising_edges_and_drops_bytes_without_stop_bit) {
+    MockPin pin;
+    comparator_t comparator;
+    rx_t rx(pin, comparator);
+
+    pin.high = true;
+    invoke<MockPin::INT>(rx);
+    EXPECT_FALSE(comparator.isInterruptOn);
+
+    sendByte(pin, comparator, rx, 42, false);
+    EXPECT_EQ(1, rx.getFramingErrors());
+    uint8_t a;
+    EXPECT_FALSE(rx.in().read(&a));
+
+    sendByte(pin, comparator, rx, 43);
+    EXPECT_TRUE(rx.in().read(&a));
+    EXPECT_EQ(43, a);
+}
+
+}
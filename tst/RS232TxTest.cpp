@@ -8,6 +8,16 @@ namespace RS232Txtest {
 using namespace Mocks;
 using namespace Serial;
 
+TEST(RS232Tx, schedule_splits_long_runs_and_ends_in_zero) {
+	using Serial::Impl::rs232Schedule;
+	// 0 | 0 0 0 0 0 0 0 0 | 1  -> 4, (long) 0, 4, (long) 0, 1, 1
+	EXPECT_EQ(uint32_t(4 | (4 << 6) | (1 << 12) | (1 << 15)), rs232Schedule(0x00));
+	// 0 | 1 0 1 0 1 0 1 0 | 1  -> ten runs of a single bit
+	EXPECT_EQ(uint32_t(01111111111), rs232Schedule(0x55));
+	// 0 | 1 1 1 1 1 1 1 1 | 1  -> 1, 4, (long) 0, 4, (long) 0, 1
+	EXPECT_EQ(uint32_t(1 | (4 << 3) | (4 << 9) | (1 << 15)), rs232Schedule(0xFF));
+}
+
 TEST(RS232Tx, should_send_until_done) {
 	MockPinOnComparator<uint8_t> pin;
 	auto rs = Serial::Impl::RS232Tx<MockPinOnComparator<uint8_t>,57600,32>(pin);
@@ -392,6 +392,54 @@ TEST(ReadingTest, reading_chunk_completes_once_bytes_are_available) {
     EXPECT_EQ(6, dest.getSize());
 }
 
+TEST(ReadingTest, resumed_read_continues_with_element_it_stopped_at) {
+    Fifo<20> src;
+    Fifo<20> destData;
+    ChunkedFifo dest(destData);
+    ReadProgress progress;
+    uint8_t length = 0;
+
+    src.write(F("1"));
+    dest.writeStart();
+    EXPECT_EQ(ReadResult::Incomplete, src.read(&progress, Decimal(&length), F(":"), ChunkWithLength(&length, dest)));
+    EXPECT_EQ(0, progress.getDone());
+    EXPECT_EQ(1, src.getSize());
+
+    src.write(F("2:abc"));
+    EXPECT_EQ(ReadResult::Incomplete, src.read(&progress, Decimal(&length), F(":"), ChunkWithLength(&length, dest)));
+    EXPECT_EQ(2, progress.getDone());
+    EXPECT_EQ(3, src.getSize());  // "12:" has been consumed
+    EXPECT_FALSE(src.isReading());
+
+    src.write(F("defghijkl"));
+    EXPECT_EQ(ReadResult::Valid, src.read(&progress, Decimal(&length), F(":"), ChunkWithLength(&length, dest)));
+    EXPECT_EQ(0, progress.getDone());
+    dest.writeEnd();
+
+    EXPECT_TRUE(src.isEmpty());
+    EXPECT_EQ(13, dest.getSize());
+}
+
+TEST(ReadingTest, resumed_read_starts_over_after_invalid_element) {
+    Fifo<20> src;
+    ReadProgress progress;
+    uint8_t length = 0, b = 0;
+
+    src.write(F("5:"));
+    EXPECT_EQ(ReadResult::Incomplete, src.read(&progress, Decimal(&length), F(":"), &b));
+    EXPECT_EQ(1, progress.getDone());  // ":" isn't committed until something follows it
+
+    src.write(F("x"));
+    EXPECT_EQ(ReadResult::Valid, src.read(&progress, Decimal(&length), F(":"), &b));
+    EXPECT_EQ(5, length);
+    EXPECT_EQ('x', b);
+
+    src.write(F("5;x"));
+    EXPECT_EQ(ReadResult::Invalid, src.read(&progress, Decimal(&length), F(":"), &b));
+    EXPECT_EQ(0, progress.getDone());
+    EXPECT_EQ(2, src.getSize());  // only the decimal was consumed
+}
+
 TEST(ReadingTest, reading_chunk_is_dropped_if_no_space_in_target_fifo) {
     Fifo<20> src;
     Fifo<5> destData;
@@ -606,6 +654,83 @@ TEST(ReadingTest, incomplete_nested_protobuf_yields_partial) {
     EXPECT_EQ(ReadResult::Valid, fifo.read(&s));
 }
 
+struct MyRepeatedPBStruct {
+    uint16_t values[3];
+    uint8_t valueCount;
+    float levels[2];
+    uint8_t levelCount;
+    char name[4];
+
+    typedef Protobuf::Protocol<MyRepeatedPBStruct> P;
+
+    typedef P::Message<
+        P::Repeated<1, uint16_t[3], &MyRepeatedPBStruct::values, &MyRepeatedPBStruct::valueCount>,
+        P::Repeated<2, float[2], &MyRepeatedPBStruct::levels, &MyRepeatedPBStruct::levelCount>,
+        P::String<3, char[4], &MyRepeatedPBStruct::name>
+    > DefaultProtocol;
+};
+
+TEST(ReadingTest, can_read_protobuf_repeated_fields_packed_and_unpacked) {
+    Fifo<32> fifo;
+    MyRepeatedPBStruct s;
+    fifo.write(FB(1 << 3, 1, 2 << 3 | 2, 4, 0, 0, 0x80, 0x3F, 1 << 3 | 2, 3, 2, 0x80, 2, 3 << 3 | 2, 2, 'h', 'i'));
+    EXPECT_EQ(ReadResult::Valid, fifo.read(&s));
+    EXPECT_EQ(3, s.valueCount);
+    EXPECT_EQ(1, s.values[0]);
+    EXPECT_EQ(2, s.values[1]);
+    EXPECT_EQ(256, s.values[2]);
+    EXPECT_EQ(1, s.levelCount);
+    EXPECT_EQ(1.0f, s.levels[0]);
+    EXPECT_STREQ("hi", s.name);
+}
+
+TEST(ReadingTest, protobuf_arrays_that_are_too_long_are_invalid) {
+    Fifo<32> fifo;
+    MyRepeatedPBStruct s;
+    fifo.write(FB(1 << 3 | 2, 4, 1, 2, 3, 4));
+    EXPECT_EQ(ReadResult::Invalid, fifo.read(&s));
+
+    fifo.clear();
+    fifo.write(FB(3 << 3 | 2, 4, 'a', 'b', 'c', 'd'));
+    EXPECT_EQ(ReadResult::Invalid, fifo.read(&s));
+}
+
+TEST(ReadingTest, unknown_protobuf_fields_of_any_wire_type_are_skipped) {
+    Fifo<32> fifo;
+    MyRepeatedPBStruct s;
+    fifo.write(FB(7 << 3 | 2, 2, 1 << 3, 9, 8 << 3 | 5, 1, 2, 3, 4, 1 << 3, 5));
+    EXPECT_EQ(ReadResult::Valid, fifo.read(&s));
+    EXPECT_EQ(1, s.valueCount);
+    EXPECT_EQ(5, s.values[0]);
+}
+
+struct MySparsePBStruct {
+    uint8_t low;
+    uint16_t high;
+    int8_t mid;
+
+    typedef Protobuf::Protocol<MySparsePBStruct> P;
+
+    typedef P::Message<
+        P::Varint<30, uint16_t, &MySparsePBStruct::high>,
+        P::Varint<2, uint8_t, &MySparsePBStruct::low>,
+        P::Varint<17, int8_t, &MySparsePBStruct::mid>
+    > DefaultProtocol;
+};
+
+TEST(ReadingTest, protobuf_fields_are_found_by_number_regardless_of_declaration_order) {
+    Fifo<32> fifo;
+    MySparsePBStruct s;
+    fifo.write(FB(17 << 3, 3, 15 << 3, 1, 2 << 3, 4, 16 << 3 | 2, 1, 0, 30 << 3, 0x80, 1));
+    EXPECT_EQ(ReadResult::Valid, fifo.read(&s));
+    EXPECT_EQ(4, s.low);
+    EXPECT_EQ(-2, s.mid);
+    EXPECT_EQ(128, s.high);
+
+    fifo.write(FB(17 << 3 | 2, 1, 0));
+    EXPECT_EQ(ReadResult::Invalid, fifo.read(&s));
+}
+
 struct MyDoubleNestedPBStruct {
     MyNestedPBStruct nested;
 
@@ -627,4 +752,49 @@ TEST(ReadingTest, can_read_double_nested_protobuf) {
     EXPECT_EQ(3, s.nested.nested.uint32);
 }
 
+TEST(ReadingTest, can_read_fixed_point) {
+    Fifo<64> fifo;
+    fifo.write(F("23.5,-0.25,7,12.345,-3.,0.5 "));
+    int16_t temperature;
+    int32_t offset;
+    uint16_t whole;
+    uint8_t truncated;
+    int8_t pointOnly;
+    uint16_t fraction;
+    EXPECT_EQ(ReadResult::Valid, fifo.read(FixedPoint<1>(&temperature), F(","), FixedPoint<3>(&offset), ',',
+                                           FixedPoint<2>(&whole), F(","), FixedPoint<1>(&truncated), ',',
+                                           FixedPoint<1>(&pointOnly), F(","), FixedPoint<2>(&fraction), F(" ")));
+    EXPECT_EQ(235, temperature);
+    EXPECT_EQ(-250, offset);
+    EXPECT_EQ(700, whole);
+    EXPECT_EQ(123, truncated);
+    EXPECT_EQ(-30, pointOnly);
+    EXPECT_EQ(50, fraction);
+}
+
+TEST(ReadingTest, fixed_point_that_does_not_fit_is_invalid) {
+    int16_t value;
+    Fifo<16> fifo;
+    fifo.write(F("3276.8 "));
+    EXPECT_EQ(ReadResult::Invalid, fifo.read(FixedPoint<1>(&value)));
+
+    fifo.clear();
+    fifo.write(F("-3276.8 "));
+    EXPECT_EQ(ReadResult::Valid, fifo.read(FixedPoint<1>(&value)));
+    EXPECT_EQ(-32768, value);
+
+    uint8_t unsignedValue;
+    fifo.clear();
+    fifo.write(F("-1 "));
+    EXPECT_EQ(ReadResult::Invalid, fifo.read(FixedPoint<0>(&unsignedValue)));
+}
+
+TEST(ReadingTest, fixed_point_is_incomplete_without_digits) {
+    int16_t value;
+    Fifo<16> fifo;
+    EXPECT_EQ(ReadResult::Incomplete, fifo.read(FixedPoint<1>(&value)));
+    fifo.write('-');
+    EXPECT_EQ(ReadResult::Incomplete, fifo.read(FixedPoint<1>(&value)));
+}
+
 }
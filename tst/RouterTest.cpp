@@ -0,0 +1,117 @@
+#include "HopeRF/Router.hpp"
+#include <gtest/gtest.h>
+#include "Mocks.hpp"
+
+namespace RouterTest {
+
+using namespace Mocks;
+using namespace HopeRF;
+using namespace Streams;
+
+struct RouterTest : public ::testing::Test {
+    MockRFM12 rfm;
+    MockRealTimer rt;
+    Router<MockRFM12, MockRealTimer, 4> router = { rfm, rt, 1 };
+};
+
+TEST_F(RouterTest, should_learn_direct_and_indirect_routes_from_topology) {
+    rfm.recv.write(FB(10, 2, 0, 2,   // from node 2, 2 entries
+        1, 0, uint8_t(-60), 1,       //   node 1 (us), -60dBm, direct
+        3, 0, uint8_t(-80), 1));     //   node 3, -80dBm, direct
+    router.loop();
+    EXPECT_TRUE(rfm.recv.isEmpty());
+
+    auto r2 = router.getRoute(2);
+    ASSERT_TRUE(r2.isDefined());
+    EXPECT_EQ(2, r2.get().via);
+    EXPECT_EQ(1, r2.get().hops);
+    EXPECT_EQ(-60, r2.get().strength);
+
+    auto r3 = router.getRoute(3);
+    ASSERT_TRUE(r3.isDefined());
+    EXPECT_EQ(2, r3.get().via);
+    EXPECT_EQ(2, r3.get().hops);
+    EXPECT_EQ(-80, r3.get().strength);
+
+    EXPECT_TRUE(router.getRoute(1).isEmpty());
+}
+
+TEST_F(RouterTest, should_keep_shortest_route) {
+    rfm.recv.write(FB(10, 2, 0, 1, 3, 0, uint8_t(-80), 1));
+    router.loop();
+    rfm.recv.write(FB(10, 3, 0, 0));
+    router.loop();
+
+    auto r3 = router.getRoute(3);
+    ASSERT_TRUE(r3.isDefined());
+    EXPECT_EQ(3, r3.get().via);
+    EXPECT_EQ(1, r3.get().hops);
+
+    rfm.recv.write(FB(10, 4, 0, 1, 3, 0, uint8_t(-50), 1));
+    router.loop();
+    EXPECT_EQ(3, router.getRoute(3).get().via);
+}
+
+TEST_F(RouterTest, should_send_via_next_hop_or_flood_when_unknown) {
+    rfm.recv.write(FB(10, 2, 0, 1, 3, 0, uint8_t(-80), 1));
+    router.loop();
+
+    EXPECT_TRUE(router.write(3, uint8_t(42)));
+    EXPECT_TRUE(rfm.sendFsk.read(FB(11, 3, 0, 1, 0, 2, 0, 0, 0, 42))); // target 3, source 1, via 2, seq 0, hops 0
+
+    EXPECT_TRUE(router.write(9, uint8_t(43)));
+    EXPECT_TRUE(rfm.sendFsk.read(FB(11, 9, 0, 1, 0, 0xFF, 0xFF, 1, 0, 43)));
+}
+
+TEST_F(RouterTest, should_deliver_packets_for_this_node_with_source) {
+    rfm.recv.write(FB(11, 1, 0, 5, 0, 1, 0, 7, 2, 42, 43)); // target 1, source 5, via 1, seq 7, 2 hops
+    router.loop();
+    EXPECT_TRUE(rfm.recv.isEmpty());
+
+    uint16_t source;
+    uint8_t a, b;
+    EXPECT_TRUE(router.in().read(&source, &a, &b));
+    EXPECT_EQ(5, source);
+    EXPECT_EQ(42, a);
+    EXPECT_EQ(43, b);
+}
+
+TEST_F(RouterTest, should_forward_flood_once_after_delay) {
+    rfm.recv.write(FB(11, 9, 0, 5, 0, 0xFF, 0xFF, 7, 0, 42));
+    router.loop();
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+
+    rfm.recv.write(FB(11, 9, 0, 5, 0, 0xFF, 0xFF, 7, 1, 42)); // same flood, via a different neighbour
+    router.loop();
+    EXPECT_TRUE(rfm.recv.isEmpty());
+
+    rt.advance(100_ms);
+    router.loop();
+    EXPECT_TRUE(rfm.sendFsk.read(FB(11, 9, 0, 5, 0, 0xFF, 0xFF, 7, 1, 42)));
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+}
+
+TEST_F(RouterTest, should_ignore_unicast_packets_for_other_next_hops) {
+    rfm.recv.write(FB(11, 9, 0, 5, 0, 4, 0, 7, 0, 42));
+    router.loop();
+    EXPECT_TRUE(rfm.recv.isEmpty());
+    rt.advance(100_ms);
+    router.loop();
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+}
+
+TEST_F(RouterTest, should_announce_table_and_expire_old_routes) {
+    rfm.recv.write(FB(10, 2, 0, 0));
+    router.loop();
+
+    router.announceNow();
+    EXPECT_TRUE(rfm.sendFsk.read(FB(10, 1, 0, 1, 2, 0, uint8_t(-106), 1)));
+
+    for (int i = 0; i <= Router<MockRFM12, MockRealTimer, 4>::MAX_AGE; i++) {
+        rt.advance(65_s);
+        router.loop();
+    }
+    EXPECT_TRUE(router.getRoute(2).isEmpty());
+}
+
+}
@@ -0,0 +1,87 @@
+#include "HopeRF/RxWindow.hpp"
+#include <gtest/gtest.h>
+#include "Mocks.hpp"
+#include "Streams/Protobuf.hpp"
+
+namespace RxWindowTest {
+
+using namespace Mocks;
+using namespace HopeRF;
+using namespace Streams;
+
+struct Reading {
+    uint8_t value;
+
+    typedef Protobuf::Protocol<Reading> P;
+
+    typedef P::Message<
+        P::Varint<1, uint8_t, &Reading::value>
+    > DefaultProtocol;
+
+    bool operator!= (const Reading &b) const { return value != b.value; }
+};
+
+struct RxWindowTest : public ::testing::Test {
+    MockRFM12 rfm;
+    RxWindow<MockRFM12, Reading, 4> rx = { rfm, 123 };
+};
+
+TEST_F(RxWindowTest, should_deliver_packets_in_order_and_ack_each_once) {
+    rfm.recv.write(FB(7, 1 << 3, 123, 2 << 3, 5, 3 << 3 | 2, 2, 1 << 3, 10));
+    auto r = rx.read();
+    ASSERT_TRUE(r.isDefined());
+    EXPECT_EQ(10, r.get().value);
+    EXPECT_TRUE(rfm.sendFsk.read(FB(8, 1 << 3, 123, 2 << 3, 5, 3 << 3, 0)));
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+
+    rfm.recv.write(FB(7, 1 << 3, 123, 2 << 3, 6, 3 << 3 | 2, 2, 1 << 3, 11));
+    r = rx.read();
+    ASSERT_TRUE(r.isDefined());
+    EXPECT_EQ(11, r.get().value);
+    EXPECT_TRUE(rfm.sendFsk.read(FB(8, 1 << 3, 123, 2 << 3, 6, 3 << 3, 0)));
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+}
+
+TEST_F(RxWindowTest, should_buffer_out_of_order_packets_and_ack_selectively) {
+    rfm.recv.write(FB(7, 1 << 3, 123, 2 << 3, 0, 3 << 3 | 2, 2, 1 << 3, 10));
+    EXPECT_TRUE(rx.read().isDefined());
+    rfm.sendFsk.clear();
+
+    rfm.recv.write(FB(7, 1 << 3, 123, 2 << 3, 2, 3 << 3 | 2, 2, 1 << 3, 12));
+    EXPECT_TRUE(rx.read().isEmpty());
+    EXPECT_TRUE(rfm.sendFsk.read(FB(8, 1 << 3, 123, 2 << 3, 0, 3 << 3, 1)));
+
+    rfm.recv.write(FB(7, 1 << 3, 123, 2 << 3, 1, 3 << 3 | 2, 2, 1 << 3, 11));
+    auto r = rx.read();
+    ASSERT_TRUE(r.isDefined());
+    EXPECT_EQ(11, r.get().value);
+    EXPECT_TRUE(rfm.sendFsk.read(FB(8, 1 << 3, 123, 2 << 3, 2, 3 << 3, 0)));
+
+    r = rx.read();
+    ASSERT_TRUE(r.isDefined());
+    EXPECT_EQ(12, r.get().value);
+    EXPECT_TRUE(rx.read().isEmpty());
+}
+
+TEST_F(RxWindowTest, should_re_ack_duplicates_without_delivering_them_again) {
+    auto incoming = FB(7, 1 << 3, 123, 2 << 3, 0, 3 << 3 | 2, 2, 1 << 3, 10);
+    rfm.recv.write(incoming);
+    EXPECT_TRUE(rx.read().isDefined());
+    rfm.sendFsk.clear();
+
+    rfm.recv.write(incoming);
+    EXPECT_TRUE(rx.read().isEmpty());
+    EXPECT_TRUE(rfm.sendFsk.read(FB(8, 1 << 3, 123, 2 << 3, 0, 3 << 3, 0)));
+}
+
+TEST_F(RxWindowTest, should_resynchronize_when_sender_restarts) {
+    rfm.recv.write(FB(7, 1 << 3, 123, 2 << 3, 50, 3 << 3 | 2, 2, 1 << 3, 10));
+    EXPECT_TRUE(rx.read().isDefined());
+
+    rfm.recv.write(FB(7, 1 << 3, 123, 2 << 3, 0, 3 << 3 | 2, 2, 1 << 3, 20));
+    auto r = rx.read();
+    ASSERT_TRUE(r.isDefined());
+    EXPECT_EQ(20, r.get().value);
+}
+
+}
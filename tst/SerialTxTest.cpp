@@ -31,6 +31,37 @@ struct MockComparator {
 
 typedef MockComparator::value_t count_t;
 
+template <SerialParity _parity, SerialBitOrder _bitOrder, uint8_t _prefix_bits = 3, uint8_t _postfix_bits = 1>
+struct TestFormat {
+    static constexpr bool highOnIdle = false;
+    static constexpr uint8_t prefix_bits = _prefix_bits;
+    static constexpr uint32_t prefix = 0b100;
+    static constexpr uint8_t postfix_bits = _postfix_bits;
+    static constexpr uint32_t postfix = 0;
+    static constexpr SerialParity parity = _parity;
+    static constexpr SerialBitOrder bitOrder = _bitOrder;
+
+    static constexpr Pulse zero_a() { return { false, 10 }; }
+    static constexpr Pulse zero_b() { return { true, 20 }; }
+    static constexpr Pulse one_a() { return { true, 30 }; }
+    static constexpr Pulse one_b() { return { false, 40 }; }
+};
+
+struct RS232Format {
+    static constexpr bool highOnIdle = false;
+    static constexpr uint8_t prefix_bits = 0;
+    static constexpr uint32_t prefix = 0;
+    static constexpr uint8_t postfix_bits = 1;
+    static constexpr uint32_t postfix = 0b1;
+    static constexpr SerialParity parity = SerialParity::NONE;
+    static constexpr SerialBitOrder bitOrder = SerialBitOrder::LSB_FIRST;
+
+    static constexpr Pulse zero_a() { return { false, 10 }; }
+    static constexpr Pulse zero_b() { return Pulse::empty(); }
+    static constexpr Pulse one_a() { return { true, 10 }; }
+    static constexpr Pulse one_b() { return Pulse::empty(); }
+};
+
 struct MockPin {
     bool high = false;
     void setHigh (bool h) {
@@ -64,9 +95,9 @@ uint8_t expect_one(tx_t &tx, uint8_t start, MockComparator &comparator, MockPin
     return start + 30 + 40;
 }
 
-template <typename comparator_t, typename pin_t, typename tx_t>
-uint8_t expectByte(tx_t &tx, SerialConfig &config, comparator_t &comparator, pin_t &pin, uint8_t t, uint8_t value) {
-    if (config.bitOrder == SerialBitOrder::LSB_FIRST) {
+template <typename config_t, typename comparator_t, typename pin_t, typename tx_t>
+uint8_t expectByte(tx_t &tx, comparator_t &comparator, pin_t &pin, uint8_t t, uint8_t value) {
+    if (config_t::bitOrder == SerialBitOrder::LSB_FIRST) {
         for (int bit = 0; bit < 8; bit++) {
             if (((value >> bit) & 1) != 0) {
                 t = expect_one(tx, t, comparator, pin);
@@ -86,8 +117,8 @@ uint8_t expectByte(tx_t &tx, SerialConfig &config, comparator_t &comparator, pin
     return t;
 }
 
-template <typename fifo_t, typename comparator_t, typename pin_t, typename tx_t>
-void transmitTestBytes(SerialConfig &config, uint8_t byte1, uint8_t byte2, fifo_t &fifo, comparator_t &comparator, pin_t &pin, tx_t &tx) {
+template <typename config_t, typename fifo_t, typename comparator_t, typename pin_t, typename tx_t>
+void transmitTestBytes(uint8_t byte1, uint8_t byte2, fifo_t &fifo, comparator_t &comparator, pin_t &pin, tx_t &tx) {
     tx.sendFromSource();
     EXPECT_TRUE(tx.isSending());
 
@@ -98,7 +129,7 @@ void transmitTestBytes(SerialConfig &config, uint8_t byte1, uint8_t byte2, fifo_
     t = expect_one(tx, t, comparator, pin);
 
     // ---- value is sent in reverse, LSB first -----------
-    t = expectByte(tx, config, comparator, pin, t, byte1);
+    t = expectByte<config_t>(tx, comparator, pin, t, byte1);
 
     // parity
     if (parity_even_bit(byte1) == 1) {
@@ -108,7 +139,7 @@ void transmitTestBytes(SerialConfig &config, uint8_t byte1, uint8_t byte2, fifo_
     }
 
     if (byte2 != 0) {
-        t = expectByte(tx, config, comparator, pin, t, byte2);
+        t = expectByte<config_t>(tx, comparator, pin, t, byte2);
 
         // parity
         if (parity_even_bit(byte2) == 1) {
@@ -128,64 +159,59 @@ void transmitTestBytes(SerialConfig &config, uint8_t byte1, uint8_t byte2, fifo_
 TEST(SerialTxTest, all_config_parts_are_transmitted_for_two_byte_messages) {
     Fifo<32> data;
     ChunkedFifo fifo(data);
-    uint8_t prefix[] = { 0b100 };
-    uint8_t postfix[] = { 0 };
-    SerialConfig config = { false, prefix, 3, {false, 10}, {true, 20}, {true, 30}, {false, 40}, SerialParity::EVEN, SerialBitOrder::LSB_FIRST, postfix, 1 };
-    ChunkPulseSource source = { fifo };
+    typedef SerialConfig<TestFormat<SerialParity::EVEN, SerialBitOrder::LSB_FIRST>> config_t;
+    ChunkPulseSource<config_t> source = { fifo };
     MockComparator comparator;
     MockPin pin;
     auto tx = pulseTx(comparator, pin, source);
 
-    fifo.write(uintptr_t(&config), uint8_t(42), uint8_t(24));
-    fifo.write(uintptr_t(&config), uint8_t(43), uint8_t(34));
-    transmitTestBytes(config, 42, 24, fifo, comparator, pin, tx);
-    transmitTestBytes(config, 43, 34, fifo, comparator, pin, tx);
+    fifo.write(uint8_t(42), uint8_t(24));
+    fifo.write(uint8_t(43), uint8_t(34));
+    transmitTestBytes<config_t>(42, 24, fifo, comparator, pin, tx);
+    transmitTestBytes<config_t>(43, 34, fifo, comparator, pin, tx);
 }
 
 TEST(SerialTxTest, all_config_parts_are_transmitted_for_single_byte_messages) {
     Fifo<32> data;
     ChunkedFifo fifo(data);
-    uint8_t prefix[] = { 0b100 };
-    uint8_t postfix[] = { 0 };
-    SerialConfig config = { false, prefix, 3, {false, 10}, {true, 20}, {true, 30}, {false, 40}, SerialParity::EVEN, SerialBitOrder::LSB_FIRST, postfix, 1 };
-    ChunkPulseSource source = { fifo };
+    typedef SerialConfig<TestFormat<SerialParity::EVEN, SerialBitOrder::LSB_FIRST>> config_t;
+    ChunkPulseSource<config_t> source = { fifo };
     MockComparator comparator;
     MockPin pin;
     auto tx = pulseTx(comparator, pin, source);
 
-    fifo.write((uintptr_t)(&config), uint8_t(42));
-    fifo.write((uintptr_t)(&config), uint8_t(43));
-    transmitTestBytes(config, 42, 0, fifo, comparator, pin, tx);
-    transmitTestBytes(config, 43, 0, fifo, comparator, pin, tx);
+    fifo.write(uint8_t(42));
+    fifo.write(uint8_t(43));
+    transmitTestBytes<config_t>(42, 0, fifo, comparator, pin, tx);
+    transmitTestBytes<config_t>(43, 0, fifo, comparator, pin, tx);
 }
 
 TEST(SerialTxTest, msb_first_messages_are_transmitted_correctly) {
     Fifo<32> data;
     ChunkedFifo fifo(data);
-    uint8_t prefix[] = { 0b100 };
-    uint8_t postfix[] = { 0 };
-    SerialConfig config = { false, prefix, 3, {false, 10}, {true, 20}, {true, 30}, {false, 40}, SerialParity::EVEN, SerialBitOrder::MSB_FIRST, postfix, 1 };
-    ChunkPulseSource source = { fifo };
+    typedef SerialConfig<TestFormat<SerialParity::EVEN, SerialBitOrder::MSB_FIRST>> config_t;
+    ChunkPulseSource<config_t> source = { fifo };
     MockComparator comparator;
     MockPin pin;
     auto tx = pulseTx(comparator, pin, source);
 
-    fifo.write((uintptr_t)(&config), uint8_t(42), uint8_t(24));
-    fifo.write((uintptr_t)(&config), uint8_t(43), uint8_t(34));
-    transmitTestBytes(config, 42, 24, fifo, comparator, pin, tx);
-    transmitTestBytes(config, 43, 34, fifo, comparator, pin, tx);
+    fifo.write(uint8_t(42), uint8_t(24));
+    fifo.write(uint8_t(43), uint8_t(34));
+    transmitTestBytes<config_t>(42, 24, fifo, comparator, pin, tx);
+    transmitTestBytes<config_t>(43, 34, fifo, comparator, pin, tx);
 }
 
 TEST(SerialTxTest, startSend_with_empty_config_and_empty_packet_causes_no_side_effect) {
     Fifo<32> data;
     ChunkedFifo fifo(data);
-    SerialConfig config = { false, nullptr, 0, {false, 10}, {true, 20}, {true, 30}, {false, 40}, SerialParity::NONE, SerialBitOrder::MSB_FIRST, nullptr, 0 };
-    ChunkPulseSource source = { fifo };
+    typedef SerialConfig<TestFormat<SerialParity::NONE, SerialBitOrder::MSB_FIRST, 0, 0>> config_t;
+    ChunkPulseSource<config_t> source = { fifo };
     MockComparator comparator;
     MockPin pin;
     auto tx = pulseTx(comparator, pin, source);
 
-    fifo.write((uintptr_t) &config);
+    fifo.writeStart();
+    fifo.writeEnd();
     tx.sendFromSource();
 
     EXPECT_EQ(0, comparator.target);
@@ -210,7 +236,7 @@ uint8_t expect_rs232_one(tx_t &tx, uint8_t start, MockComparator &comparator, Mo
 }
 
 template <typename tx_t, typename comparator_t, typename pin_t>
-uint8_t expectRS232Byte(tx_t &tx, SerialConfig &config, comparator_t &comparator, pin_t &pin, uint8_t t, uint8_t value) {
+uint8_t expectRS232Byte(tx_t &tx, comparator_t &comparator, pin_t &pin, uint8_t t, uint8_t value) {
         for (int bit = 0; bit < 8; bit++) {
             if (((value >> bit) & 1) != 0) {
                 t = expect_rs232_one(tx, t, comparator, pin);
@@ -223,11 +249,9 @@ uint8_t expectRS232Byte(tx_t &tx, SerialConfig &config, comparator_t &comparator
 
 TEST(SerialTxTest, can_send_rs232_8n1_data) {
     Fifo<32> data;
-    uint8_t postfix[] = { 0b1 };
-    SerialConfig config = { false, nullptr, 0, {false, 10}, Pulse::empty(), {true, 10}, Pulse::empty(), SerialParity::NONE, SerialBitOrder::LSB_FIRST, postfix, 1 };
     MockComparator comparator;
     MockPin pin;
-    StreamPulseSource source(data, config);
+    StreamPulseSource<SerialConfig<RS232Format>> source(data);
     auto tx = pulseTx(comparator, pin, source);
 
     data.write(uint8_t(42), uint8_t(24));
@@ -235,9 +259,9 @@ TEST(SerialTxTest, can_send_rs232_8n1_data) {
 
     uint8_t t = 5;
 
-    t = expectRS232Byte(tx, config, comparator, pin, t, 42);
+    t = expectRS232Byte(tx, comparator, pin, t, 42);
     t = expect_rs232_one(tx, t, comparator, pin);
-    t = expectRS232Byte(tx, config, comparator, pin, t, 24);
+    t = expectRS232Byte(tx, comparator, pin, t, 24);
     EXPECT_TRUE(tx.isSending());
     t = expect_rs232_one(tx, t, comparator, pin);
 
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "HAL/Atmel/TWIScheduler.hpp"
+#include "Mocks.hpp"
+
+namespace TWISchedulerTest {
+
+using namespace HAL::Atmel;
+using namespace Mocks;
+using namespace Streams;
+
+TEST(TWISchedulerTest, starts_longest_conversion_first_and_reads_nearby_conversions_together) {
+    MockRealTimer rt;
+    MockTWI twi;
+    auto scheduler = twiScheduler<4>(twi, rt, 20_ms);
+    scheduler.add(0x40, 0xF3, 3, 90_ms, 1_s);
+    scheduler.add(0x23, 0x20, 2, 100_ms, 1_s);
+
+    scheduler.loop();
+    EXPECT_EQ(2, twi.transactions);
+    uint8_t first = 0, second = 0;
+    twi.out.read(&first, &second);
+    EXPECT_EQ(0x20, first);
+    EXPECT_EQ(0xF3, second);
+    EXPECT_FALSE(scheduler.getTaskState().isIdle());
+
+    rt.advance(90_ms);
+    scheduler.loop();
+    EXPECT_EQ(2, twi.transactions);
+
+    rt.advance(10_ms);
+    scheduler.loop();
+    EXPECT_EQ(4, twi.transactions);
+    EXPECT_EQ(HAL::Atmel::SleepMode::IDLE, scheduler.getTaskState().getMaxSleepMode());
+}
+
+TEST(TWISchedulerTest, returns_read_bytes_once_per_measurement) {
+    MockRealTimer rt;
+    MockTWI twi;
+    auto scheduler = twiScheduler<4>(twi, rt, 20_ms);
+    uint8_t slot = scheduler.add(0x23, 0x20, 2, 120_ms, 1_s).get();
+
+    scheduler.loop();
+    rt.advance(120_ms);
+    scheduler.loop();
+    EXPECT_EQ(0x23, twi.readAddress);
+    EXPECT_EQ(2, twi.readCount);
+    EXPECT_FALSE(scheduler.hasResult(slot));
+
+    twi.result->append(0x12);
+    twi.result->append(0x34);
+    twi.result->complete(TWIStatus::DONE);
+    scheduler.loop();
+
+    EXPECT_TRUE(scheduler.hasResult(slot));
+    uint8_t hi = 0, lo = 0;
+    EXPECT_EQ(ReadResult::Valid, scheduler.read(slot, &hi, &lo));
+    EXPECT_EQ(0x12, hi);
+    EXPECT_EQ(0x34, lo);
+    EXPECT_FALSE(scheduler.hasResult(slot));
+}
+
+TEST(TWISchedulerTest, scan_finds_acknowledging_addresses) {
+    MockRealTimer rt;
+    MockTWI twi;
+    auto scheduler = twiScheduler<4>(twi, rt);
+
+    scheduler.startScan();
+    for (uint8_t address = 0x08; address <= 0x77; address++) {
+        EXPECT_TRUE(scheduler.isScanning());
+        scheduler.loop();
+        EXPECT_EQ(address, twi.readAddress);
+        twi.result->complete((address == 0x23) ? TWIStatus::DONE : TWIStatus::FAILED);
+    }
+    scheduler.loop();
+
+    EXPECT_FALSE(scheduler.isScanning());
+    EXPECT_TRUE(scheduler.isPresent(0x23));
+    EXPECT_FALSE(scheduler.isPresent(0x24));
+}
+
+}
@@ -24,8 +24,10 @@ struct MockTWIInfo {
     constexpr auto TW = ~(TWPS0 | TWPS1 | TWS3 | TWS4 | TWS5 | TWS6 | TWS7);
 
     constexpr auto TW_START       = TW | TWS3;
+    constexpr auto TW_REP_START   = TW | TWS4;
     constexpr auto TW_MT_SLA_ACK  = TW | TWS3 | TWS4;
     constexpr auto TW_MT_DATA_ACK = TW | TWS3 | TWS5;
+    constexpr auto TW_MT_SLA_NACK = TW | TWS5;
     constexpr auto TW_MR_SLA_ACK  = TW | TWS6;
     constexpr auto TW_MR_DATA_NACK= TW | TWS3 | TWS4 | TWS6;
     constexpr auto TW_MR_DATA_ACK = TW | TWS4 | TWS6;
@@ -91,16 +93,11 @@ TEST(TWITest, can_read_a_one_byte_message_ended_with_NACK) {
         TWSR = TW_MR_SLA_ACK;
         invoke<Int_TWI_>(twi);
 
-        EXPECT_EQ(TWEN | TWIE | TWINT | TWEA, TWCR);
-
-        TWSR = TW_MR_DATA_ACK;
-        TWDR.val() = 123;
-        invoke<Int_TWI_>(twi);
-
+        // only one byte is expected, so it is to be NACKed
         EXPECT_EQ(TWEN | TWIE | TWINT, TWCR);
 
         TWSR = TW_MR_DATA_NACK;
-        TWDR.val() = 255;
+        TWDR.val() = 123;
         invoke<Int_TWI_>(twi);
 
 		while(running) {
@@ -158,4 +155,82 @@ TEST(TWITest, starts_a_second_queued_up_write_after_first_completes) {
   EXPECT_FALSE(twi.isTransceiving());
 
 }
+
+TEST(TWITest, reads_a_register_using_a_repeated_start) {
+    TWCR = ~(TWIE | TWEN | TWWC | TWSTO | TWSTA | TWEA | TWINT);
+    HAL::Atmel::Impl::TWI<MockTWIInfo,32,32,100000> twi;
+    TWIResult<2> result;
+    EXPECT_TRUE(twi.readRegister(84, 0x8C, result));
+    EXPECT_TRUE(result.isPending());
+    EXPECT_FALSE(twi.readRegister(84, 0x8C, result));
+
+    TWSR = TW_START;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ(84 << 1, TWDR.val());
+
+    TWSR = TW_MT_SLA_ACK;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ(0x8C, TWDR.val());
+
+    TWSR = TW_MT_DATA_ACK;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ(TWEN | TWIE | TWEA | TWINT | TWSTA, TWCR);
+
+    TWSR = TW_REP_START;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ((84 << 1) | 1, TWDR.val());
+
+    TWSR = TW_MR_SLA_ACK;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ(TWEN | TWIE | TWINT | TWEA, TWCR);
+
+    TWSR = TW_MR_DATA_ACK;
+    TWDR.val() = 0x12;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ(TWEN | TWIE | TWINT, TWCR);
+    EXPECT_TRUE(result.isPending());
+
+    TWSR = TW_MR_DATA_NACK;
+    TWDR.val() = 0x34;
+    invoke<Int_TWI_>(twi);
+
+    EXPECT_FALSE(twi.isTransceiving());
+    EXPECT_TRUE(result.isDone());
+    uint8_t lo = 0, hi = 0;
+    EXPECT_EQ(ReadResult::Valid, result.read(&lo, &hi));
+    EXPECT_EQ(0x12, lo);
+    EXPECT_EQ(0x34, hi);
+}
+
+TEST(TWITest, continues_with_next_transaction_after_slave_nacks) {
+    TWCR = ~(TWIE | TWEN | TWWC | TWSTO | TWSTA | TWEA | TWINT);
+    HAL::Atmel::Impl::TWI<MockTWIInfo,32,32,100000> twi;
+    TWIResult<1> first;
+    EXPECT_TRUE(twi.readRegister(84, 1, first));
+    EXPECT_TRUE(twi.write(85, uint8_t(42)));
+
+    TWSR = TW_START;
+    invoke<Int_TWI_>(twi);
+    TWSR = TW_MT_SLA_NACK;
+    invoke<Int_TWI_>(twi);
+
+    EXPECT_TRUE(first.isFailed());
+    EXPECT_EQ(1, twi.getErrors());
+    EXPECT_TRUE(twi.isTransceiving());
+    EXPECT_EQ(TWEN | TWIE | TWEA | TWINT | TWSTA, TWCR);
+
+    TWSR = TW_START;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ(85 << 1, TWDR.val());
+
+    TWSR = TW_MT_SLA_ACK;
+    invoke<Int_TWI_>(twi);
+    EXPECT_EQ(42, TWDR.val());
+
+    TWSR = TW_MT_DATA_ACK;
+    invoke<Int_TWI_>(twi);
+
+    EXPECT_FALSE(twi.isTransceiving());
+}
+
 }
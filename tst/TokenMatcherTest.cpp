@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "Fifo.hpp"
+#include "Streams/TokenMatcher.hpp"
+
+namespace TokenMatcherTest {
+
+using namespace Streams;
+
+typedef TokenMatcher<STR("he"), STR("she"), STR("his"), STR("hers")> Matcher;
+
+TEST(TokenMatcherTest, finds_first_complete_token_including_overlapping_ones) {
+    Matcher m;
+    Fifo<16> fifo;
+    fifo.write(F("ushers"));
+
+    EXPECT_EQ(int(Matcher::id<STR("she")>()), m.scan(fifo));
+    EXPECT_EQ(2, fifo.getSize());
+    EXPECT_EQ(0, m.scan(fifo));
+    EXPECT_EQ(0, fifo.getSize());
+}
+
+TEST(TokenMatcherTest, reports_suffix_token_when_longer_token_fails) {
+    Matcher m;
+    Fifo<16> fifo;
+    fifo.write(F("shis"));
+
+    EXPECT_EQ(int(Matcher::id<STR("his")>()), m.scan(fifo));
+}
+
+TEST(TokenMatcherTest, continues_token_split_over_several_scans_without_rereading) {
+    Matcher m;
+    Fifo<16> fifo;
+    fifo.write(F("xxhe"));
+    EXPECT_EQ(int(Matcher::id<STR("he")>()), m.scan(fifo));
+
+    fifo.write(F("-hi"));
+    EXPECT_EQ(0, m.scan(fifo));
+    EXPECT_EQ(0, fifo.getSize());
+
+    fifo.write(F("s"));
+    EXPECT_EQ(int(Matcher::id<STR("his")>()), m.scan(fifo));
+}
+
+TEST(TokenMatcherTest, unread_token_is_returned_again_without_consuming) {
+    Matcher m;
+    Fifo<16> fifo;
+    fifo.write(F("he12"));
+    EXPECT_EQ(1, m.scan(fifo));
+    m.unread(1);
+    EXPECT_EQ(1, m.scan(fifo));
+    EXPECT_EQ(2, fifo.getSize());
+}
+
+}
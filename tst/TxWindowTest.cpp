@@ -0,0 +1,104 @@
+#include "HopeRF/TxWindow.hpp"
+#include <gtest/gtest.h>
+#include "Mocks.hpp"
+#include "Streams/Protobuf.hpp"
+
+namespace TxWindowTest {
+
+using namespace Mocks;
+using namespace HopeRF;
+using namespace Streams;
+
+struct Reading {
+    uint8_t value;
+
+    typedef Protobuf::Protocol<Reading> P;
+
+    typedef P::Message<
+        P::Varint<1, uint8_t, &Reading::value>
+    > DefaultProtocol;
+
+    bool operator!= (const Reading &b) const { return value != b.value; }
+};
+
+struct TxWindowTest : public ::testing::Test {
+    MockRFM12 rfm;
+    MockRealTimer rt;
+    TxWindow<MockRFM12, MockRealTimer, Reading, 3> tx = { rfm, rt, 123 };
+};
+
+TEST_F(TxWindowTest, should_send_up_to_window_size_without_waiting_for_acks) {
+    EXPECT_TRUE(tx.send({ 10 }));
+    EXPECT_TRUE(tx.send({ 11 }));
+    EXPECT_TRUE(tx.send({ 12 }));
+    EXPECT_TRUE(tx.isFull());
+    EXPECT_FALSE(tx.send({ 13 }));
+    EXPECT_EQ(3, tx.getInFlight());
+
+    EXPECT_TRUE(rfm.sendFsk.read(FB(6, 1 << 3, 123, 2 << 3, 0, 3 << 3 | 2, 2, 1 << 3, 10)));
+    EXPECT_TRUE(rfm.sendFsk.read(FB(6, 1 << 3, 123, 2 << 3, 1, 3 << 3 | 2, 2, 1 << 3, 11)));
+    EXPECT_TRUE(rfm.sendFsk.read(FB(6, 1 << 3, 123, 2 << 3, 2, 3 << 3 | 2, 2, 1 << 3, 12)));
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+}
+
+TEST_F(TxWindowTest, should_release_window_on_cumulative_ack) {
+    tx.send({ 10 });
+    tx.send({ 11 });
+    tx.send({ 12 });
+    rfm.recv.write(FB(9, 1 << 3, 123, 2 << 3, 1, 3 << 3, 0)); // ack up to seq 1
+    tx.loop();
+
+    EXPECT_EQ(1, tx.getInFlight());
+    EXPECT_FALSE(tx.getTaskState().isIdle());
+
+    rfm.recv.write(FB(9, 1 << 3, 123, 2 << 3, 2, 3 << 3, 0));
+    tx.loop();
+    EXPECT_EQ(0, tx.getInFlight());
+    EXPECT_TRUE(tx.getTaskState().isIdle());
+}
+
+TEST_F(TxWindowTest, should_only_resend_packets_missing_from_selective_ack) {
+    tx.send({ 10 });
+    tx.send({ 11 });
+    tx.send({ 12 });
+    rfm.sendFsk.clear();
+    rfm.recv.write(FB(9, 1 << 3, 123, 2 << 3, 0, 3 << 3, 1)); // ack seq 0, and seq 2 out of order
+    tx.loop();
+    EXPECT_EQ(2, tx.getInFlight());
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+
+    rt.advance(1600_ms);
+    tx.loop();
+    EXPECT_TRUE(rfm.sendFsk.read(FB(6, 1 << 3, 123, 2 << 3, 1, 3 << 3 | 2, 2, 1 << 3, 11)));
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+}
+
+TEST_F(TxWindowTest, should_ignore_acks_for_other_nodes) {
+    tx.send({ 10 });
+    rfm.recv.write(FB(9, 1 << 3, 124, 2 << 3, 0, 3 << 3, 0));
+    tx.loop();
+    EXPECT_EQ(1, tx.getInFlight());
+}
+
+TEST_F(TxWindowTest, should_adapt_resend_timeout_to_round_trip_time) {
+    tx.send({ 10 });
+    rt.advance(20_ms);
+    rfm.recv.write(FB(9, 1 << 3, 123, 2 << 3, 0, 3 << 3, 0));
+    tx.loop();
+
+    // 312 counts measured, with an initial variation of half that, times 4.
+    EXPECT_EQ(312 + 624, tx.getTimeout().getValue());
+
+    tx.send({ 11 });
+    rfm.sendFsk.clear();
+    rt.advance(40_ms);
+    tx.loop();
+    EXPECT_TRUE(rfm.sendFsk.isEmpty());
+
+    rt.advance(100_ms);
+    tx.loop();
+    EXPECT_FALSE(rfm.sendFsk.isEmpty());
+    EXPECT_EQ(2 * (312 + 624), tx.getTimeout().getValue());
+}
+
+}
@@ -158,6 +158,57 @@ TEST(WritingTest, can_write_decimal_int32) {
     EXPECT_TRUE(fifo.isEmpty());
 }
 
+TEST(WritingTest, decimal_uint32_matches_reference_formatting) {
+    char out[Impl::Format::maxDecimalLength];
+    auto check = [&out] (uint32_t v) {
+        const uint8_t length = Impl::Format::toDecimal(out, v);
+        EXPECT_EQ(std::to_string(v), std::string(out, length));
+    };
+    for (uint32_t p = 1; p <= 1000000000; p *= 10) {
+        check(p - 1);
+        check(p);
+        check(p + 1);
+    }
+    check(4294967295);
+    uint32_t v = 1;
+    for (uint32_t i = 0; i < 100000; i++) {
+        v = v * 1664525 + 1013904223;
+        check(v);
+        check(v >> (i % 32));
+    }
+}
+
+TEST(WritingTest, decimal_int32_is_written_after_a_single_space_check) {
+    Fifo<8> fifo;
+    EXPECT_FALSE(fifo.write(dec(int32_t(-12345678))));
+    EXPECT_TRUE(fifo.isEmpty());
+    EXPECT_TRUE(fifo.write(dec(int32_t(-1234567))));
+    EXPECT_TRUE(fifo.read(F("-1234567")));
+}
+
+TEST(WritingTest, can_write_hexadecimal_uint16_and_uint32) {
+    Fifo<32> fifo;
+    fifo.write(Hexadecimal(uint16_t(0x0A5F)), ' ', Hexadecimal(uint32_t(0xDEADBEEF)), ' ', Hexadecimal(uint32_t(0x12)));
+    EXPECT_TRUE(fifo.read(F("0A5F DEADBEEF 00000012")));
+    EXPECT_TRUE(fifo.isEmpty());
+}
+
+TEST(WritingTest, can_write_fixed_point) {
+    Fifo<64> fifo;
+    fifo.write(FixedPoint<1>(int16_t(235)), ' ', FixedPoint<1>(int16_t(-5)), ' ', FixedPoint<2>(uint8_t(7)), ' ',
+               FixedPoint<3>(int32_t(-2147483648)), ' ', FixedPoint<0>(uint16_t(42)), ' ', FixedPoint<2>(uint32_t(0)));
+    EXPECT_TRUE(fifo.read(F("23.5 -0.5 0.07 -2147483.648 42 0.00")));
+    EXPECT_TRUE(fifo.isEmpty());
+}
+
+TEST(WritingTest, fixed_point_is_written_after_a_single_space_check) {
+    Fifo<8> fifo;
+    EXPECT_FALSE(fifo.write(FixedPoint<2>(int32_t(-1234567))));
+    EXPECT_TRUE(fifo.isEmpty());
+    EXPECT_TRUE(fifo.write(FixedPoint<2>(int32_t(-12345))));
+    EXPECT_TRUE(fifo.read(F("-123.45")));
+}
+
 TEST(WritingTest, can_write_nested) {
     Fifo<32> fifo;
     uint8_t a = 1;
@@ -290,6 +341,20 @@ struct Struct2 {
     > DefaultProtocol;
 };
 
+TEST(WritingTest, can_write_struct_field_as_fixed_point) {
+    Fifo<8> fifo;
+    Struct1 s = {42, 5};
+    typedef Protocol<Struct1> P;
+    typedef P::Seq<
+        P::FixedPoint<uint8_t, 1, &Struct1::a>,
+        P::FixedPoint<uint8_t, 2, &Struct1::b>
+    > CustomProto;
+
+    fifo.write(as<CustomProto>(&s));
+    EXPECT_TRUE(fifo.read(F("4.20.05")));
+    EXPECT_TRUE(fifo.isEmpty());
+}
+
 TEST(WritingTest, can_write_const_struct_with_nested_struct_of_default_protocol) {
     Fifo<8> fifo;
     const Struct2 s = { {1, 2} };
@@ -614,6 +679,96 @@ TEST(WritingTest, can_write_protobuf_struct_with_optional) {
 	EXPECT_EQ(some(42), s.optB);
 }
 
+struct SpaciousMockFifo: public MockFifo {
+    inline int getSpace() {
+        getSpaceCount++;
+        return 100;
+    }
+};
+
+TEST(WritingTest, protobuf_struct_checks_space_once_for_its_maximum_size) {
+    EXPECT_EQ(3 + 4 + 6 + 3 + 4, int(MyPBStruct::DefaultProtocol::maxContentLength));
+
+    SpaciousMockFifo fifo;
+    MyPBStruct s;
+    s.uint8 = 42;
+    s.uint16 = 0xFEDB;
+    s.uint32 = 0xFEDBFEDB;
+    s.optA = 40;
+    s.optB = none();
+    EXPECT_TRUE(Impl::writeIfSpace(fifo, &s));
+    EXPECT_EQ(1, fifo.getSpaceCount);
+    EXPECT_EQ(14, fifo.writeInvocations);
+}
+
+TEST(WritingTest, protobuf_struct_checks_each_field_if_maximum_size_does_not_fit) {
+    MockFifo fifo;
+    MyPBStruct s;
+    s.uint8 = 1;
+    s.uint16 = 0xFFFF;
+    s.uint32 = 0;
+    s.optA = none();
+    s.optB = none();
+    EXPECT_FALSE(Impl::writeIfSpace(fifo, &s));
+    EXPECT_EQ(3, fifo.getSpaceCount);  // the whole message, then the first two fields
+}
+
+struct MyRichPBStruct {
+    uint32_t fixed;
+    float f;
+    int64_t big;
+    uint8_t data[4];
+    uint8_t dataLength;
+    char name[8];
+    int16_t samples[4];
+    uint8_t sampleCount;
+
+    typedef Protobuf::Protocol<MyRichPBStruct> P;
+
+    typedef P::Message<
+        P::Fixed32<1, uint32_t, &MyRichPBStruct::fixed>,
+        P::Float<2, &MyRichPBStruct::f>,
+        P::Fixed64<3, int64_t, &MyRichPBStruct::big>,
+        P::Bytes<4, uint8_t[4], &MyRichPBStruct::data, &MyRichPBStruct::dataLength>,
+        P::String<5, char[8], &MyRichPBStruct::name>,
+        P::Repeated<6, int16_t[4], &MyRichPBStruct::samples, &MyRichPBStruct::sampleCount>
+    > DefaultProtocol;
+};
+
+TEST(WritingTest, can_write_protobuf_struct_with_fixed_bytes_string_and_packed_fields) {
+    Fifo<48> fifo;
+    MyRichPBStruct s = { 0x01020304, 1.0f, -2, { 0xAA, 0xBB }, 2, "hi", { 1, -1, 300 }, 3 };
+    fifo.write(&s);
+    const auto expected = FB(
+        1 << 3 | 5, 4, 3, 2, 1,
+        2 << 3 | 5, 0, 0, 0x80, 0x3F,
+        3 << 3 | 1, 0xFE, 255, 255, 255, 255, 255, 255, 255,
+        4 << 3 | 2, 2, 0xAA, 0xBB,
+        5 << 3 | 2, 2, 'h', 'i',
+        6 << 3 | 2, 4, 2, 1, 0xD8, 4);
+    EXPECT_TRUE(fifo.read(expected));
+
+    fifo.write(&s);
+    MyRichPBStruct r = {};
+    EXPECT_EQ(ReadResult::Valid, fifo.read(&r));
+    EXPECT_EQ(0x01020304u, r.fixed);
+    EXPECT_EQ(1.0f, r.f);
+    EXPECT_EQ(-2, r.big);
+    EXPECT_EQ(2, r.dataLength);
+    EXPECT_EQ(0xBB, r.data[1]);
+    EXPECT_STREQ("hi", r.name);
+    EXPECT_EQ(3, r.sampleCount);
+    EXPECT_EQ(-1, r.samples[1]);
+    EXPECT_EQ(300, r.samples[2]);
+}
+
+TEST(WritingTest, protobuf_leaves_out_empty_repeated_field) {
+    Fifo<48> fifo;
+    MyRichPBStruct s = { 0, 0.0f, 0, {}, 0, "", {}, 0 };
+    fifo.write(&s);
+    EXPECT_EQ(5 + 5 + 9 + 2 + 2, fifo.getSize());
+}
+
 TEST(WritingTest, can_write_optional_decimal) {
 	Option<uint8_t> present = 42;
 	Option<uint8_t> absent = none();
@@ -24,3 +24,14 @@ uint16_t _crc16_update(uint16_t crc, uint8_t a) {
     }
     return crc;
 }
+
+uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data) {
+    crc = crc ^ data;
+    for (uint8_t i = 0; i < 8; i++) {
+        if (crc & 0x01)
+            crc = (crc >> 1) ^ 0x8C;
+        else
+            crc >>= 1;
+    }
+    return crc;
+}
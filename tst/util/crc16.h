@@ -4,5 +4,6 @@
 #include "avr/common.h"
 
 uint16_t _crc16_update(uint16_t crc, uint8_t a);
+uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data);
 
 #endif